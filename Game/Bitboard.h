@@ -0,0 +1,604 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+typedef uint32_t BB; // Битовая маска 32 игровых клеток
+
+// Нумерация игровых клеток: клетка (x, y), где (x + y) % 2 == 1, имеет индекс x * 4 + y / 2.
+// Так обход индексов по возрастанию совпадает с обходом доски по строкам.
+inline int sq_index(const POS_T x, const POS_T y)
+{
+    return x * 4 + y / 2;
+}
+
+inline POS_T sq_x(const int sq)
+{
+    return POS_T(sq >> 2);
+}
+
+inline POS_T sq_y(const int sq)
+{
+    return POS_T(2 * (sq & 3) + !((sq >> 2) & 1)); // В чётных строках игровые клетки в нечётных столбцах
+}
+
+// Количество установленных битов
+inline int pop_count(const BB b)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(b));
+#else
+    return __builtin_popcount(b);
+#endif
+}
+
+// Индекс младшего установленного бита (b != 0)
+inline int lsb(const BB b)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, b);
+    return int(idx);
+#else
+    return __builtin_ctz(b);
+#endif
+}
+
+// Маски строк и крайних столбцов в нумерации по 4 клетки на строку
+constexpr BB EVEN_ROWS = 0x0F0F0F0F; // Строки 0, 2, 4, 6
+constexpr BB ODD_ROWS = 0xF0F0F0F0;  // Строки 1, 3, 5, 7
+constexpr BB COL_FIRST = 0x11111111; // Первая игровая клетка каждой строки
+constexpr BB COL_LAST = 0x88888888;  // Последняя игровая клетка каждой строки
+constexpr BB ROW_0 = 0x0000000F;     // Строка превращения белых
+constexpr BB ROW_7 = 0xF0000000;     // Строка превращения черных
+
+inline constexpr BB row_mask(const int row)
+{
+    return BB(0xF) << (4 * row);
+}
+
+// Направления: 0 - (-1, -1), 1 - (-1, +1), 2 - (+1, -1), 3 - (+1, +1).
+// Порядок совпадает с порядком перебора направлений в исходном алгоритме поиска ходов.
+constexpr POS_T DIR_X[4] = { -1, -1, 1, 1 };
+constexpr POS_T DIR_Y[4] = { -1, 1, -1, 1 };
+
+// Сдвиг всей маски на одну клетку в направлении dir
+inline BB shift(const BB b, const int dir)
+{
+    switch (dir)
+    {
+    case 0:
+        return ((b & EVEN_ROWS) >> 4) | ((b & ODD_ROWS & ~COL_FIRST) >> 5);
+    case 1:
+        return ((b & EVEN_ROWS & ~COL_LAST) >> 3) | ((b & ODD_ROWS) >> 4);
+    case 2:
+        return ((b & EVEN_ROWS) << 4) | ((b & ODD_ROWS & ~COL_FIRST) << 3);
+    default:
+        return ((b & EVEN_ROWS & ~COL_LAST) << 5) | ((b & ODD_ROWS) << 4);
+    }
+}
+
+// Таблица соседей: NEIGHBOR[sq][dir] - индекс соседней клетки или -1 у края доски
+constexpr array<array<int8_t, 4>, 32> make_neighbors()
+{
+    array<array<int8_t, 4>, 32> res{};
+    for (int sq = 0; sq < 32; ++sq)
+    {
+        const int x = sq >> 2, y = 2 * (sq & 3) + !((sq >> 2) & 1);
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            const int x2 = x + DIR_X[dir], y2 = y + DIR_Y[dir];
+            res[sq][dir] = (x2 < 0 || x2 > 7 || y2 < 0 || y2 > 7) ? -1 : int8_t(x2 * 4 + y2 / 2);
+        }
+    }
+    return res;
+}
+inline constexpr array<array<int8_t, 4>, 32> NEIGHBOR = make_neighbors();
+
+// Ход в битовом представлении: индексы клеток откуда, куда и битой фигуры (-1, если взятия нет)
+struct bit_move
+{
+    int8_t from = -1, to = -1, cap = -1;
+
+    bit_move() = default;
+    bit_move(const int from, const int to, const int cap = -1) : from(int8_t(from)), to(int8_t(to)), cap(int8_t(cap))
+    {
+    }
+
+    bool operator==(const bit_move& other) const
+    {
+        return from == other.from && to == other.to && cap == other.cap;
+    }
+
+    // Перевод в ход в координатах доски
+    move_pos to_move_pos() const
+    {
+        if (cap == -1)
+            return move_pos(sq_x(from), sq_y(from), sq_x(to), sq_y(to));
+        return move_pos(sq_x(from), sq_y(from), sq_x(to), sq_y(to), sq_x(cap), sq_y(cap));
+    }
+};
+
+// Клетка в шашечной нотации: столбец a..h, строка 1..8 (белые внизу)
+inline string square_name(const int sq)
+{
+    return string(1, char('a' + sq_y(sq))) + char('8' - sq_x(sq));
+}
+
+// Запись хода: клетки шагов через '-' (тихий ход) или ':' (взятия), например "c3-d4" или "e3:c5:e7"
+inline string move_name(const vector<bit_move>& steps)
+{
+    string res;
+    for (const auto& step : steps)
+    {
+        if (res.empty())
+            res = square_name(step.from);
+        res += (step.cap != -1 ? ":" : "-") + square_name(step.to);
+    }
+    return res;
+}
+
+// Наибольшее число ходов в позиции. В пустую клетку можно прийти не более чем с 4 направлений,
+// и с каждого направления - только одной фигурой (ближайшей или бьющей ближайшую фигуру противника),
+// поэтому ходов не больше 4 * 31 < 128.
+constexpr int MAX_TURNS = 128;
+
+// Список ходов фиксированной вместимости: размещается на стеке, память в куче не выделяется
+struct MoveList
+{
+    bit_move turns[MAX_TURNS];
+    int count = 0;
+
+    template <class... Args> void emplace_back(Args... args)
+    {
+        turns[count++] = bit_move(args...);
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    bit_move& operator[](const int i)
+    {
+        return turns[i];
+    }
+
+    bit_move* begin()
+    {
+        return turns;
+    }
+
+    bit_move* end()
+    {
+        return turns + count;
+    }
+
+    const bit_move* begin() const
+    {
+        return turns;
+    }
+
+    const bit_move* end() const
+    {
+        return turns + count;
+    }
+};
+
+// Потенциал простой цвета color на клетке sq: сколько строк она прошла к строке превращения
+inline int man_potential(const bool color, const int sq)
+{
+    return color ? sq >> 2 : 7 - (sq >> 2);
+}
+
+struct Position;
+
+// Ключи Зобриста для хеширования позиции
+struct Zobrist
+{
+    uint64_t piece[4][32]; // Ключи фигур: тип фигуры (1..4) - 1, клетка
+    uint64_t side; // Ключ хода черных
+    uint64_t perspective; // Ключ стороны, за которую считает бот (оценки разных сторон не смешиваются)
+
+    Zobrist()
+    {
+        mt19937_64 gen(20240601); // Фиксированное зерно: ключи одинаковы при каждом запуске
+        for (auto& keys : piece)
+            for (auto& key : keys)
+                key = gen();
+        side = gen();
+        perspective = gen();
+    }
+
+    // Хеш позиции с учетом цвета, который ходит
+    uint64_t hash(const Position& pos, const bool color) const;
+};
+
+inline const Zobrist zobrist;
+
+// Позиция: три маски - белые фигуры, черные фигуры и дамки обоих цветов.
+// Счетчики для оценки позиции и хеш расстановки обновляются в make_turn/unmake_turn; после изменения масок
+// напрямую их пересчитывает refresh().
+struct Position
+{
+    BB white = 0, black = 0, kings = 0;
+    int8_t men_count[2] = {}, kings_count[2] = {}; // Число простых и дамок по цветам
+    int8_t potential[2] = {}; // Сумма потенциалов простых по цветам
+    uint64_t key = 0; // Хеш Зобриста расстановки фигур (без цвета, который ходит)
+
+    // Пересчет счетчиков и хеша по маскам
+    void refresh()
+    {
+        for (int color = 0; color < 2; ++color)
+        {
+            const BB own = color ? black : white;
+            men_count[color] = int8_t(pop_count(own & ~kings));
+            kings_count[color] = int8_t(pop_count(own & kings));
+            int pot = 0;
+            for (BB b = own & ~kings; b; b &= b - 1)
+                pot += man_potential(color, lsb(b));
+            potential[color] = int8_t(pot);
+        }
+        key = 0;
+        for (BB b = occupied(); b; b &= b - 1)
+        {
+            const int sq = lsb(b);
+            key ^= zobrist.piece[piece(sq) - 1][sq];
+        }
+    }
+
+    // Построение позиции по матрице доски (1 - белая, 2 - черная, 3 - белая дамка, 4 - черная дамка)
+    static Position from_mtx(const vector<vector<POS_T>>& mtx)
+    {
+        Position pos;
+        for (int sq = 0; sq < 32; ++sq)
+        {
+            const POS_T type = mtx[sq_x(sq)][sq_y(sq)];
+            if (!type)
+                continue;
+            const BB bit = BB(1) << sq;
+            if (type % 2)
+                pos.white |= bit;
+            else
+                pos.black |= bit;
+            if (type > 2)
+                pos.kings |= bit;
+        }
+        pos.refresh();
+        return pos;
+    }
+
+    // Начальная расстановка
+    static Position start()
+    {
+        Position pos;
+        pos.black = 0x00000FFF;
+        pos.white = 0xFFF00000;
+        pos.refresh();
+        return pos;
+    }
+
+    // Позиция из строки из 32 символов клеток в порядке индексов:
+    // 'w', 'b' - простые фигуры, 'W', 'B' - дамки, '.' - пустая клетка
+    static bool from_string(const string& str, Position& pos)
+    {
+        if (str.size() < 32)
+            return false;
+        pos = Position();
+        for (int sq = 0; sq < 32; ++sq)
+        {
+            const BB bit = BB(1) << sq;
+            switch (str[sq])
+            {
+            case 'W':
+                pos.kings |= bit;
+                [[fallthrough]];
+            case 'w':
+                pos.white |= bit;
+                break;
+            case 'B':
+                pos.kings |= bit;
+                [[fallthrough]];
+            case 'b':
+                pos.black |= bit;
+                break;
+            case '.':
+                break;
+            default:
+                return false;
+            }
+        }
+        pos.refresh();
+        return true;
+    }
+
+    // Запись позиции строкой в формате from_string
+    string to_string() const
+    {
+        string res(32, '.');
+        for (int sq = 0; sq < 32; ++sq)
+            res[sq] = " wbWB"[piece(sq)];
+        for (auto& c : res)
+            if (c == ' ')
+                c = '.';
+        return res;
+    }
+
+    // Тип фигуры на клетке в кодировке матрицы доски
+    POS_T piece(const int sq) const
+    {
+        const BB bit = BB(1) << sq;
+        if (!((white | black) & bit))
+            return 0;
+        return POS_T(((black & bit) ? 2 : 1) + ((kings & bit) ? 2 : 0));
+    }
+
+    BB occupied() const
+    {
+        return white | black;
+    }
+
+    BB empty() const
+    {
+        return ~(white | black);
+    }
+
+    bool operator==(const Position& other) const
+    {
+        return white == other.white && black == other.black && kings == other.kings;
+    }
+};
+
+inline uint64_t Zobrist::hash(const Position& pos, const bool color) const
+{
+    return pos.key ^ (color ? side : 0);
+}
+
+// Данные для отмены шага хода: тип битой фигуры (0, если взятия не было) и флаг превращения в дамку
+struct undo_info
+{
+    POS_T captured = 0;
+    bool promoted = false;
+};
+
+// Выполнение одного шага хода на месте (с превращением в дамку на последней строке)
+inline undo_info make_turn(Position& pos, const bit_move turn)
+{
+    undo_info undo;
+    if (turn.cap != -1) // Если есть взятие
+    {
+        undo.captured = pos.piece(turn.cap);
+        const BB cap = ~(BB(1) << turn.cap);
+        pos.white &= cap;
+        pos.black &= cap;
+        pos.kings &= cap;
+        pos.key ^= zobrist.piece[undo.captured - 1][turn.cap];
+        const bool cap_color = !(undo.captured % 2);
+        if (undo.captured > 2)
+            --pos.kings_count[cap_color];
+        else
+        {
+            --pos.men_count[cap_color];
+            pos.potential[cap_color] -= int8_t(man_potential(cap_color, turn.cap));
+        }
+    }
+    const BB from = BB(1) << turn.from, to = BB(1) << turn.to;
+    const bool color = !(pos.white & from);
+    const int type = color + ((pos.kings & from) ? 2 : 0); // Тип фигуры - 1 (для ключей Зобриста)
+    if (pos.kings & from)
+        pos.kings ^= from | to;
+    else if (to & (color ? ROW_7 : ROW_0))
+    {
+        pos.kings |= to; // Превращение в дамку
+        undo.promoted = true;
+        --pos.men_count[color];
+        ++pos.kings_count[color];
+        pos.potential[color] -= int8_t(man_potential(color, turn.from));
+    }
+    else
+        pos.potential[color] += int8_t(man_potential(color, turn.to) - man_potential(color, turn.from));
+    if (color)
+        pos.black ^= from | to;
+    else
+        pos.white ^= from | to;
+    pos.key ^= zobrist.piece[type][turn.from] ^ zobrist.piece[type + (undo.promoted ? 2 : 0)][turn.to];
+    return undo;
+}
+
+// Отмена шага хода, выполненного make_turn
+inline void unmake_turn(Position& pos, const bit_move turn, const undo_info undo)
+{
+    const BB from = BB(1) << turn.from, to = BB(1) << turn.to;
+    const bool color = !(pos.white & to);
+    const int type = color + ((pos.kings & to) ? 2 : 0); // Тип фигуры на клетке to - 1
+    pos.key ^= zobrist.piece[type - (undo.promoted ? 2 : 0)][turn.from] ^ zobrist.piece[type][turn.to];
+    if (undo.promoted)
+    {
+        pos.kings &= ~to;
+        ++pos.men_count[color];
+        --pos.kings_count[color];
+        pos.potential[color] += int8_t(man_potential(color, turn.from));
+    }
+    else if (pos.kings & to)
+        pos.kings ^= from | to;
+    else
+        pos.potential[color] -= int8_t(man_potential(color, turn.to) - man_potential(color, turn.from));
+    if (color)
+        pos.black ^= from | to;
+    else
+        pos.white ^= from | to;
+    if (undo.captured) // Возврат битой фигуры
+    {
+        const BB cap = BB(1) << turn.cap;
+        pos.key ^= zobrist.piece[undo.captured - 1][turn.cap];
+        const bool cap_color = !(undo.captured % 2);
+        if (cap_color)
+            pos.black |= cap;
+        else
+            pos.white |= cap;
+        if (undo.captured > 2)
+        {
+            pos.kings |= cap;
+            ++pos.kings_count[cap_color];
+        }
+        else
+        {
+            ++pos.men_count[cap_color];
+            pos.potential[cap_color] += int8_t(man_potential(cap_color, turn.cap));
+        }
+    }
+}
+
+// Взятия дамки с клетки sq (дамка ходит на любое расстояние)
+inline void gen_king_beats(const int sq, const BB own, const BB opp, MoveList& turns)
+{
+    for (int dir = 0; dir < 4; ++dir)
+    {
+        int cap = -1;
+        for (int s = NEIGHBOR[sq][dir]; s != -1; s = NEIGHBOR[s][dir])
+        {
+            const BB bit = BB(1) << s;
+            if (own & bit)
+                break;
+            if (opp & bit)
+            {
+                if (cap != -1)
+                    break;
+                cap = s;
+                continue;
+            }
+            if (cap != -1)
+                turns.emplace_back(sq, s, cap);
+        }
+    }
+}
+
+// Тихие ходы дамки с клетки sq
+inline void gen_king_moves(const Position& pos, const int sq, MoveList& turns)
+{
+    const BB occ = pos.occupied();
+    for (int dir = 0; dir < 4; ++dir)
+    {
+        for (int s = NEIGHBOR[sq][dir]; s != -1 && !(occ & (BB(1) << s)); s = NEIGHBOR[s][dir])
+            turns.emplace_back(sq, s);
+    }
+}
+
+// Поиск всех ходов цвета color (0 - белые, 1 - черные); если есть взятия, возвращаются только они.
+// Порядок ходов совпадает с обходом доски по строкам. Возвращает флаг наличия взятий.
+// Функции генерации не имеют общего изменяемого состояния и могут вызываться из нескольких потоков.
+inline bool gen_turns(const Position& pos, const bool color, MoveList& turns)
+{
+    turns.clear();
+    const BB own = color ? pos.black : pos.white;
+    const BB opp = color ? pos.white : pos.black;
+    const BB empty = pos.empty();
+    const BB men = own & ~pos.kings;
+
+    // Взятия простыми фигурами сразу для всей доски: шаг на фигуру противника и шаг на пустую клетку
+    BB beats[4];
+    BB beat_any = own & pos.kings;
+    for (int dir = 0; dir < 4; ++dir)
+    {
+        beats[dir] = shift(shift(empty, 3 - dir) & opp, 3 - dir) & men;
+        beat_any |= beats[dir];
+    }
+    for (BB b = beat_any; b; b &= b - 1)
+    {
+        const int sq = lsb(b);
+        const BB bit = BB(1) << sq;
+        if (pos.kings & bit)
+        {
+            gen_king_beats(sq, own, opp, turns);
+            continue;
+        }
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (beats[dir] & bit)
+            {
+                const int cap = NEIGHBOR[sq][dir];
+                turns.emplace_back(sq, NEIGHBOR[cap][dir], cap);
+            }
+        }
+    }
+    if (!turns.empty())
+        return true;
+
+    // Тихие ходы: простые фигуры ходят только вперед
+    const int dir0 = color ? 2 : 0;
+    const BB moves0 = shift(empty, 3 - dir0) & men;
+    const BB moves1 = shift(empty, 2 - dir0) & men;
+    for (BB b = (moves0 | moves1) | (own & pos.kings); b; b &= b - 1)
+    {
+        const int sq = lsb(b);
+        const BB bit = BB(1) << sq;
+        if (pos.kings & bit)
+        {
+            gen_king_moves(pos, sq, turns);
+            continue;
+        }
+        if (moves0 & bit)
+            turns.emplace_back(sq, NEIGHBOR[sq][dir0]);
+        if (moves1 & bit)
+            turns.emplace_back(sq, NEIGHBOR[sq][dir0 + 1]);
+    }
+    return false;
+}
+
+// Поиск ходов фигуры на клетке sq; если есть взятия, возвращаются только они
+inline bool gen_piece_turns(const Position& pos, const int sq, MoveList& turns)
+{
+    turns.clear();
+    const BB bit = BB(1) << sq;
+    const bool color = (pos.black & bit) != 0;
+    const BB own = color ? pos.black : pos.white;
+    const BB opp = color ? pos.white : pos.black;
+    const BB empty = pos.empty();
+    if (pos.kings & bit)
+    {
+        gen_king_beats(sq, own, opp, turns);
+        if (!turns.empty())
+            return true;
+        gen_king_moves(pos, sq, turns);
+        return false;
+    }
+    for (int dir = 0; dir < 4; ++dir)
+    {
+        const int cap = NEIGHBOR[sq][dir];
+        if (cap == -1 || !(opp & (BB(1) << cap)))
+            continue;
+        const int to = NEIGHBOR[cap][dir];
+        if (to != -1 && (empty & (BB(1) << to)))
+            turns.emplace_back(sq, to, cap);
+    }
+    if (!turns.empty())
+        return true;
+    const int dir0 = color ? 2 : 0;
+    for (int dir = dir0; dir < dir0 + 2; ++dir)
+    {
+        const int to = NEIGHBOR[sq][dir];
+        if (to != -1 && (empty & (BB(1) << to)))
+            turns.emplace_back(sq, to);
+    }
+    return false;
+}
@@ -5,6 +5,7 @@
 
 #include "../Models/Move.h"
 #include "../Models/Project_path.h"
+#include "Logger.h"
 
 #ifdef __APPLE__
 #include <SDL2/SDL.h>
@@ -71,9 +72,16 @@ public:
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
         }
+        // Картинки результата загружаются один раз; без них игра идет, но результат не показывается
+        white_wins = IMG_LoadTexture(ren, white_path.c_str());
+        black_wins = IMG_LoadTexture(ren, black_path.c_str());
+        draw = IMG_LoadTexture(ren, draw_path.c_str());
+        if (!white_wins || !black_wins || !draw)
+            print_exception("IMG_LoadTexture can't load game result pictures from " + textures_path);
         SDL_GetRendererOutputSize(ren, &W, &H);  // Получение текущих размеров рендерера
         make_start_mtx();  // Создание начальной расстановки фигур
-        rerender();  // Отрисовка доски
+        dirty = true;
+        flush();  // Отрисовка доски
         return 0;
     }
 
@@ -81,8 +89,7 @@ public:
     void redraw()
     {
         game_results = -1;  // Сброс результата игры
-        history_mtx.clear();  // Очистка истории ходов
-        history_beat_series.clear();  // Очистка истории серий ударов
+        history.clear();  // Очистка истории ходов
         make_start_mtx();  // Создание начальной расстановки
         clear_active();  // Сброс активной ячейки
         clear_highlight();  // Сброс выделения ячеек
@@ -91,16 +98,7 @@ public:
     // Перемещение фигуры по заданному ходу
     void move_piece(move_pos turn, const int beat_series = 0)
     {
-        if (turn.xb != -1)  // Если ход включает взятие фигуры
-        {
-            mtx[turn.xb][turn.yb] = 0;  // Удаление битой фигуры
-        }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);  // Перемещение фигуры
-    }
-
-    // Перемещение фигуры из одной позиции в другую
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
-    {
+        const POS_T i = turn.x, j = turn.y, i2 = turn.x2, j2 = turn.y2;
         if (mtx[i2][j2])  // Проверка, что конечная позиция свободна
         {
             throw runtime_error("final position is not empty, can't move");
@@ -109,18 +107,33 @@ public:
         {
             throw runtime_error("begin position is empty, can't move");
         }
+        // Запись в историю: битая фигура и превращение нужны для отмены хода на месте
+        history.push_back({ turn, 0, false, POS_T(beat_series) });
+        if (turn.xb != -1)  // Если ход включает взятие фигуры
+        {
+            history.back().captured = mtx[turn.xb][turn.yb];
+            mtx[turn.xb][turn.yb] = 0;  // Удаление битой фигуры
+        }
         if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))  // Превращение в дамку
+        {
             mtx[i][j] += 2;
+            history.back().promoted = true;
+        }
         mtx[i2][j2] = mtx[i][j];  // Перемещение фигуры
         drop_piece(i, j);  // Удаление фигуры из начальной позиции
-        add_history(beat_series);  // Добавление хода в историю
+    }
+
+    // Перемещение фигуры из одной позиции в другую
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    {
+        move_piece(move_pos(i, j, i2, j2), beat_series);
     }
 
     // Удаление фигуры с доски
     void drop_piece(const POS_T i, const POS_T j)
     {
         mtx[i][j] = 0;  // Очистка ячейки
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Превращение фигуры в дамку
@@ -131,7 +144,7 @@ public:
             throw runtime_error("can't turn into queen in this position");
         }
         mtx[i][j] += 2;  // Превращение в дамку
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Получение текущего состояния доски
@@ -148,7 +161,7 @@ public:
             POS_T x = pos.first, y = pos.second;
             is_highlighted_[x][y] = 1;
         }
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Сброс подсветки ячеек
@@ -158,7 +171,7 @@ public:
         {
             is_highlighted_[i].assign(8, 0);  // Очистка массива подсветки
         }
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Установка активной ячейки
@@ -166,7 +179,7 @@ public:
     {
         active_x = x;
         active_y = y;
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Сброс активной ячейки
@@ -174,7 +187,7 @@ public:
     {
         active_x = -1;
         active_y = -1;
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Проверка, подсвечена ли ячейка
@@ -183,16 +196,38 @@ public:
         return is_highlighted_[x][y];
     }
 
-    // Отмена последнего хода
+    // Можно ли отменить ход
+    bool can_undo() const
+    {
+        return !history.empty();
+    }
+
+    // Число ходов (шагов серий ударов) в истории
+    size_t history_size() const
+    {
+        return history.size();
+    }
+
+    // Номер последнего удара в серии (0 - последний ход был тихим или ходов не было)
+    int last_beat_series() const
+    {
+        return history.empty() ? 0 : history.back().beat_series;
+    }
+
+    // Отмена последнего хода (всей последней серии ударов) на месте
     void rollback()
     {
-        auto beat_series = max(1, *(history_beat_series.rbegin()));  // Получение серии ударов
-        while (beat_series-- && history_mtx.size() > 1)  // Отмена ходов
+        auto beat_series = max(1, last_beat_series());  // Получение серии ударов
+        while (beat_series-- && !history.empty())  // Отмена ходов
         {
-            history_mtx.pop_back();
-            history_beat_series.pop_back();
+            const history_entry& last = history.back();
+            const move_pos& turn = last.turn;
+            mtx[turn.x][turn.y] = mtx[turn.x2][turn.y2] - (last.promoted ? 2 : 0);  // Возврат фигуры
+            mtx[turn.x2][turn.y2] = 0;
+            if (last.captured)  // Возврат битой фигуры
+                mtx[turn.xb][turn.yb] = last.captured;
+            history.pop_back();
         }
-        mtx = *(history_mtx.rbegin());  // Восстановление состояния доски
         clear_highlight();  // Сброс подсветки
         clear_active();  // Сброс активной ячейки
     }
@@ -201,14 +236,25 @@ public:
     void show_final(const int res)
     {
         game_results = res;  // Установка результата игры
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
     }
 
     // Сброс размеров окна
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);  // Получение текущих размеров окна
-        rerender();  // Перерисовка доски
+        dirty = true;  // Доска будет перерисована в следующем кадре
+    }
+
+    // Отрисовка кадра, если с прошлой отрисовки доска изменилась: изменения копятся и выводятся
+    // одним кадром перед ожиданием ввода или перед паузой и поиском бота
+    void flush()
+    {
+        SDL_PumpEvents();  // Окно отвечает системе и во время хода бота
+        if (!dirty)
+            return;
+        dirty = false;
+        rerender();
     }
 
     // Завершение работы с SDL
@@ -221,6 +267,9 @@ public:
         SDL_DestroyTexture(b_queen);
         SDL_DestroyTexture(back);
         SDL_DestroyTexture(replay);
+        SDL_DestroyTexture(white_wins);
+        SDL_DestroyTexture(black_wins);
+        SDL_DestroyTexture(draw);
         SDL_DestroyRenderer(ren);  // Уничтожение рендерера
         SDL_DestroyWindow(win);  // Уничтожение окна
         SDL_Quit();  // Завершение работы SDL
@@ -233,13 +282,6 @@ public:
     }
 
 private:
-    // Добавление текущего состояния доски в историю
-    void add_history(const int beat_series = 0)
-    {
-        history_mtx.push_back(mtx);  // Сохранение состояния доски
-        history_beat_series.push_back(beat_series);  // Сохранение серии ударов
-    }
-
     // Создание начальной расстановки фигур
     void make_start_mtx()
     {
@@ -254,7 +296,6 @@ private:
                     mtx[i][j] = 1;
             }
         }
-        add_history();  // Сохранение начального состояния
     }
 
     // Перерисовка всех элементов доски
@@ -323,39 +364,27 @@ private:
         // Отрисовка результата игры
         if (game_results != -1)
         {
-            string result_path = draw_path;
+            SDL_Texture* result_texture = draw;
             if (game_results == 1)
-                result_path = white_path;
+                result_texture = white_wins;
             else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result_texture = black_wins;
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);  // Отрисовка результата
-            SDL_DestroyTexture(result_texture);
+            if (result_texture)
+                SDL_RenderCopy(ren, result_texture, NULL, &res_rect);  // Отрисовка результата
         }
 
-        SDL_RenderPresent(ren);  // Обновление рендерера
-        SDL_Delay(10);  // Задержка для стабильности
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);  // Обработка событий
+        SDL_RenderPresent(ren);  // Обновление рендерера (с вертикальной синхронизацией)
     }
 
     // Логирование ошибок
     void print_exception(const string& text) {
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Error: " << text << ". " << SDL_GetError() << endl;
-        fout.close();
+        Logger::instance().error(text, { { "sdl_error", SDL_GetError() } });
     }
 
 public:
     int W = 0;  // Ширина окна
     int H = 0;  // Высота окна
-    vector<vector<vector<POS_T>>> history_mtx;  // История состояний доски
 
 private:
     SDL_Window* win = nullptr;  // Окно SDL
@@ -368,6 +397,9 @@ private:
     SDL_Texture* b_queen = nullptr;  // Текстура черной дамки
     SDL_Texture* back = nullptr;  // Текстура кнопки "Назад"
     SDL_Texture* replay = nullptr;  // Текстура кнопки "Переиграть"
+    SDL_Texture* white_wins = nullptr;  // Текстура победы белых
+    SDL_Texture* black_wins = nullptr;  // Текстура победы черных
+    SDL_Texture* draw = nullptr;  // Текстура ничьей
     // Пути к текстурам
     const string textures_path = project_path + "Textures/";
     const string board_path = textures_path + "board.png";
@@ -384,11 +416,22 @@ private:
     int active_x = -1, active_y = -1;
     // Результат игры
     int game_results = -1;
+    // Доска изменилась после последней отрисовки
+    bool dirty = false;
     // Матрица подсветки ячеек
     vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(8, vector<bool>(8, 0));
     // Матрица состояния доски
     // 1 - белая фигура, 2 - черная фигура, 3 - белая дамка, 4 - черная дамка
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
-    // История серий ударов
-    vector<int> history_beat_series;
+    // Запись истории ходов: ход, тип битой фигуры (0 - взятия не было), превращение в дамку
+    // и номер удара в серии (0 - тихий ход); 9 байт на ход
+    struct history_entry
+    {
+        move_pos turn;
+        POS_T captured;
+        bool promoted;
+        POS_T beat_series;
+    };
+    // История ходов от начальной расстановки
+    vector<history_entry> history;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+#include "TT.h"
+
+// Дебютная книга: для позиций начала партии хранится ход, найденный заранее глубоким поиском
+// (книгу строит утилита Tools/bookgen.cpp).
+//
+// Формат файла: заголовок book_header, затем записи book_entry, отсортированные по хешу позиции
+// (Zobrist::hash с учетом цвета, который ходит); поиск записи - двоичный.
+// В заголовке хранится уровень поиска, которым построена книга: бот младшего уровня ее не использует.
+
+constexpr uint32_t BOOK_VERSION = 2;
+constexpr int BOOK_MAX_STEPS = 7; // Наибольшее число шагов хода (серии взятий), который помещается в запись
+
+// Заголовок файла книги
+struct book_header
+{
+    char magic[4]; // "CKBK"
+    uint32_t version; // BOOK_VERSION
+    uint32_t level; // Уровень поиска, которым найдены ходы
+    uint32_t reserved;
+    uint64_t count; // Число записей
+};
+
+// Запись книги: хеш позиции и ход - клетка, откуда ходит фигура, и клетки, куда она приходит
+// на каждом шаге серии; неиспользуемые клетки равны 0xFF
+struct book_entry
+{
+    uint64_t key;
+    uint8_t path[BOOK_MAX_STEPS + 1];
+
+    bool operator<(const book_entry& other) const
+    {
+        return key < other.key;
+    }
+
+    // Запись по ходу; false, если ход не помещается в запись
+    static bool make(const uint64_t key, const vector<bit_move>& turns, book_entry& entry)
+    {
+        if (turns.empty() || turns.size() > size_t(BOOK_MAX_STEPS))
+            return false;
+        entry.key = key;
+        memset(entry.path, 0xFF, sizeof(entry.path));
+        entry.path[0] = uint8_t(turns[0].from);
+        for (size_t i = 0; i < turns.size(); ++i)
+            entry.path[i + 1] = uint8_t(turns[i].to);
+        return true;
+    }
+};
+
+// Книга, отображенная в память (MappedFile)
+class OpeningBook
+{
+public:
+    // Открытие файла книги; false, если файла нет или он поврежден
+    bool load(const string& path)
+    {
+        entries = nullptr;
+        count = 0;
+        book_level = 0;
+        if (!file.open(path))
+            return false;
+        book_header header;
+        if (file.size() < sizeof(header))
+            return false;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, "CKBK", 4) || header.version != BOOK_VERSION ||
+            header.count > (file.size() - sizeof(header)) / sizeof(book_entry))
+            return false;
+        entries = reinterpret_cast<const book_entry*>(file.data() + sizeof(header));
+        count = size_t(header.count);
+        book_level = int(header.level);
+        return true;
+    }
+
+    // Уровень поиска, которым построена книга
+    int level() const
+    {
+        return book_level;
+    }
+
+    // Ход из книги для цвета color; false, если позиции нет в книге. Ход проверяется по правилам,
+    // поэтому совпадение хеша другой позиции не приводит к невозможному ходу.
+    bool probe(const Position& pos, const bool color, vector<bit_move>& turns) const
+    {
+        turns.clear();
+        book_entry target;
+        target.key = zobrist.hash(pos, color);
+        const book_entry* entry = lower_bound(entries, entries + count, target);
+        if (entry == entries + count || entry->key != target.key)
+            return false;
+
+        Position cur = pos;
+        int sq = entry->path[0];
+        for (int i = 1; i <= BOOK_MAX_STEPS && entry->path[i] != 0xFF; ++i)
+        {
+            MoveList list;
+            const bool have_beats = (i == 1 ? gen_turns(cur, color, list) : gen_piece_turns(cur, sq, list));
+            if (i > 1 && !have_beats) // Серия продолжается только взятиями
+                return false;
+            auto turn = find_if(list.begin(), list.end(),
+                                [&](const bit_move& t) { return t.from == sq && t.to == entry->path[i]; });
+            if (turn == list.end())
+                return false;
+            turns.push_back(*turn);
+            make_turn(cur, *turn);
+            sq = turn->to;
+            if (turn->cap == -1) // Тихий ход - из одного шага
+                return i == 1 && entry->path[2] == 0xFF;
+        }
+        MoveList list;
+        return !turns.empty() && !gen_piece_turns(cur, sq, list); // Серия взятий доведена до конца
+    }
+
+private:
+    MappedFile file; // Файл книги
+    const book_entry* entries = nullptr; // Отсортированные записи
+    size_t count = 0; // Число записей
+    int book_level = 0; // Уровень поиска книги
+};
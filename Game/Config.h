@@ -1,30 +1,239 @@
 ﻿#pragma once
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 #include "../Models/Project_path.h"
+#include "FileWatcher.h"
+#include "Logger.h"
+
+// Режим подсчета очков бота
+enum class ScoringType
+{
+    NumberOnly, // Только число фигур
+    NumberAndPotential, // Число фигур и их продвижение
+    Nnue // Нейросетевая оценка из файла "Nnue" (без файла - NumberAndPotential)
+};
+
+// Режим оптимизации поиска
+enum class Optimization
+{
+    O0, // Полный перебор
+    O1, // Альфа-бета отсечения и таблица транспозиций
+    O2 // Пока то же, что O1
+};
+
+// Настройки, разобранные из settings.json один раз при загрузке.
+// Значения по умолчанию используются для отсутствующих настроек.
+struct Settings
+{
+    struct
+    {
+        unsigned width = 0; // 0 - размер по умолчанию
+        unsigned height = 0;
+    } window;
+
+    struct
+    {
+        bool is_bot[2] = { false, true }; // По цветам: 0 - белые, 1 - черные
+        int level[2] = { 0, 5 };
+        ScoringType scoring = ScoringType::NumberAndPotential;
+        unsigned delay_ms = 0;
+        bool no_random = false;
+        Optimization optimization = Optimization::O1;
+        size_t tt_size_mb = 16;
+        long long time_ms = 0; // 0 - без ограничения
+        size_t nodes = 0; // 0 - без ограничения
+        int threads = 1; // 0 - все ядра
+        string tablebase = "tablebase.bin"; // Пустая строка - таблицы не используются
+        string book; // Файл дебютной книги; пустая строка - книга не используется
+        string nnue = "nnue.bin"; // Сеть для режима подсчета Nnue
+        string weights = "weights.json"; // Веса оценок; пустая строка - веса по умолчанию
+        string search_stats; // Файл статистики поиска (строка JSON на ход); пустая строка - не пишется
+        bool ponder = true;
+    } bot;
+
+    struct
+    {
+        int max_num_turns = 120;
+        LogLevel log_level = LogLevel::Info; // Записи лога ниже уровня не сохраняются
+    } game;
+};
 
 class Config
 {
 public:
-    Config()
+    Config() : watcher(make_shared<FileWatcher>(project_path + "settings.json"))
     {
         reload();  // При создании объекта загружаем настройки из файла.
     }
 
-    void reload()
+    // Настройки, заданные в коде (например, в утилитах без окна и файла настроек).
+    explicit Config(const json& config)
     {
+        if (!parse(config, settings, error))
+            throw runtime_error("Bad settings: " + error);
+    }
+
+    // Перечитывание файла настроек; при ошибке остаются прежние настройки, а описание ошибки - в last_error().
+    bool reload()
+    {
+        error.clear();
         std::ifstream fin(project_path + "settings.json");  // Открываем файл настроек.
-        fin >> config;  // Читаем JSON и сохраняем в объект config.
-        fin.close();    // Закрываем файл.
+        if (!fin)
+        {
+            error = "cannot open settings.json";
+            return false;
+        }
+        json config = json::parse(fin, nullptr, false);  // Читаем JSON без исключений.
+        if (config.is_discarded())
+        {
+            error = "settings.json is not valid JSON";
+            return false;
+        }
+        Settings res;
+        if (!parse(config, res, error))
+            return false;
+        settings = res;
+        return true;
+    }
+
+    // Изменился ли файл настроек с прошлой проверки (без ожидания).
+    bool changed()
+    {
+        return watcher && watcher->changed();
+    }
+
+    const Settings& get() const
+    {
+        return settings;
     }
 
-    auto operator()(const string& setting_dir, const string& setting_name) const
+    // Ошибка последней загрузки (пустая строка - ошибок не было).
+    const string& last_error() const
     {
-        return config[setting_dir][setting_name];  // Получаем значение настройки по её пути в JSON.
+        return error;
     }
 
 private:
-    json config;  // Объект для хранения настроек в формате JSON.
+    // Разбор и проверка настроек: все ошибки собираются в error через "; ".
+    static bool parse(const json& config, Settings& s, string& error)
+    {
+        if (!config.is_object())
+        {
+            error = "settings must be a JSON object";
+            return false;
+        }
+        read(config, "WindowSize", "Width", s.window.width, error);
+        read(config, "WindowSize", "Hight", s.window.height, error);
+        read(config, "Bot", "IsWhiteBot", s.bot.is_bot[0], error);
+        read(config, "Bot", "IsBlackBot", s.bot.is_bot[1], error);
+        read(config, "Bot", "WhiteBotLevel", s.bot.level[0], error);
+        read(config, "Bot", "BlackBotLevel", s.bot.level[1], error);
+        read(config, "Bot", "BotDelayMS", s.bot.delay_ms, error);
+        read(config, "Bot", "NoRandom", s.bot.no_random, error);
+        read(config, "Bot", "TTSizeMB", s.bot.tt_size_mb, error);
+        read(config, "Bot", "BotTimeMS", s.bot.time_ms, error);
+        read(config, "Bot", "BotNodes", s.bot.nodes, error);
+        read(config, "Bot", "Threads", s.bot.threads, error);
+        read(config, "Bot", "Tablebase", s.bot.tablebase, error);
+        read(config, "Bot", "Book", s.bot.book, error);
+        read(config, "Bot", "Nnue", s.bot.nnue, error);
+        read(config, "Bot", "Weights", s.bot.weights, error);
+        read(config, "Bot", "SearchStats", s.bot.search_stats, error);
+        read(config, "Bot", "Ponder", s.bot.ponder, error);
+        read(config, "Game", "MaxNumTurns", s.game.max_num_turns, error);
+
+        string scoring;
+        if (read(config, "Bot", "BotScoringType", scoring, error))
+        {
+            if (scoring == "NumberOnly")
+                s.bot.scoring = ScoringType::NumberOnly;
+            else if (scoring == "NumberAndPotential")
+                s.bot.scoring = ScoringType::NumberAndPotential;
+            else if (scoring == "Nnue")
+                s.bot.scoring = ScoringType::Nnue;
+            else
+                add_error(error, "Bot.BotScoringType: expected \"NumberOnly\", \"NumberAndPotential\" or \"Nnue\"");
+        }
+        string log_level;
+        if (read(config, "Game", "LogLevel", log_level, error))
+        {
+            if (log_level == "Debug")
+                s.game.log_level = LogLevel::Debug;
+            else if (log_level == "Info")
+                s.game.log_level = LogLevel::Info;
+            else if (log_level == "Warning")
+                s.game.log_level = LogLevel::Warning;
+            else if (log_level == "Error")
+                s.game.log_level = LogLevel::Error;
+            else
+                add_error(error, "Game.LogLevel: expected \"Debug\", \"Info\", \"Warning\" or \"Error\"");
+        }
+        string optimization;
+        if (read(config, "Bot", "Optimization", optimization, error))
+        {
+            if (optimization == "O0")
+                s.bot.optimization = Optimization::O0;
+            else if (optimization == "O1")
+                s.bot.optimization = Optimization::O1;
+            else if (optimization == "O2")
+                s.bot.optimization = Optimization::O2;
+            else
+                add_error(error, "Bot.Optimization: expected \"O0\", \"O1\" or \"O2\"");
+        }
+        return error.empty();
+    }
+
+    // Чтение одной настройки с проверкой типа; false, если настройки нет или она неверна
+    template <class T> static bool read(const json& config, const char* dir, const char* name, T& value, string& error)
+    {
+        const auto section = config.find(dir);
+        if (section == config.end() || !section->is_object())
+            return false;
+        const auto it = section->find(name);
+        if (it == section->end())
+            return false;
+        bool ok;
+        const char* expected;
+        if constexpr (is_same_v<T, bool>)
+        {
+            ok = it->is_boolean();
+            expected = "true or false";
+        }
+        else if constexpr (is_same_v<T, string>)
+        {
+            ok = it->is_string();
+            expected = "a string";
+        }
+        else // Все числовые настройки неотрицательные
+        {
+            ok = it->is_number_unsigned() || (it->is_number_integer() && it->template get<long long>() >= 0);
+            ok = ok && it->template get<unsigned long long>() <= static_cast<unsigned long long>(numeric_limits<T>::max());
+            expected = "a non-negative integer";
+        }
+        if (!ok)
+        {
+            add_error(error, string(dir) + "." + name + ": expected " + expected + ", got " + it->dump());
+            return false;
+        }
+        value = it->template get<T>();
+        return true;
+    }
+
+    static void add_error(string& error, const string& message)
+    {
+        if (!error.empty())
+            error += "; ";
+        error += message;
+    }
+
+    Settings settings;  // Разобранные настройки.
+    string error;  // Ошибка последней загрузки.
+    shared_ptr<FileWatcher> watcher;  // Слежение за файлом настроек (общее для копий конфига).
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Bitboard.h"
+#include "EvalKernel.h"
+
+// Оценки - целые и симметричные: SCORE_SCALE * ln(материал стороны first_bot_color / материал соперника),
+// то есть 0 - равный материал, оценка за соперника - та же оценка с обратным знаком. Порядок оценок
+// тот же, что у отношения материала, а целые границы окна позволяют нулевые окна поиска (PVS).
+constexpr int SCORE_SCALE = 1000; // Единица оценки - 0.001 натурального логарифма отношения
+constexpr int WIN_SCORE = 1000000; // У соперника нет фигур или ходов (проигрыш - минус)
+const int INF = 1e9; // Бесконечность для алгоритма: граница окна больше любой оценки
+
+// Оценки позиции для листьев поиска. Поиск параметризуется оценкой (Logic::find_best_turns_rec<Eval, ...>),
+// поэтому вызов Eval::score встраивается без проверок режима. Новая оценка - новая структура
+// со статической функцией score и строка выбора в Logic::select_search.
+// Число фигур и потенциал простых берутся из счетчиков позиции, которые make_turn/unmake_turn
+// обновляют на каждом шаге, поэтому оценка не обходит доску. Те же оценки по маскам для пачки позиций
+// считает score_batch через ядро EvalKernel.h.
+// Веса оценок (eval_weights) подбирает утилита Tools/texeltune.cpp, бот читает их из файла "Weights".
+
+// Веса оценок по фигурам; значения по умолчанию - подобранные вручную
+struct eval_weights
+{
+    double potential = 0.05; // Вес одного ряда продвижения простой (NumberAndPotential)
+    double king_number_only = 4; // Дамка в простых для NumberOnly
+    double king = 5; // Дамка в простых для NumberAndPotential
+};
+
+// Оценка по материалу стороны first_bot_color и соперника: w, wq - простые и дамки белых, b, bq - черных
+inline int material_score(double w, double wq, double b, double bq, const double q_coef, const bool first_bot_color)
+{
+    if (!first_bot_color) // Если бот играет за черных
+    {
+        swap(b, w);
+        swap(bq, wq);
+    }
+    if (w + wq == 0) // Если белых нет
+        return WIN_SCORE;
+    if (b + bq == 0) // Если черных нет
+        return -WIN_SCORE;
+    return int(lround(SCORE_SCALE * log((b + bq * q_coef) / (w + wq * q_coef))));
+}
+
+// Только число фигур, дамка стоит w.king_number_only простых
+struct NumberOnlyEval
+{
+    static constexpr bool uses_accumulator = false; // Оценке не нужно состояние поиска
+
+    // P - Position или eval_terms
+    template <class P> static int score(const P& pos, const bool first_bot_color, const eval_weights& w)
+    {
+        return material_score(pos.men_count[0], pos.kings_count[0], pos.men_count[1], pos.kings_count[1],
+                              w.king_number_only, first_bot_color);
+    }
+};
+
+// Число фигур и продвижение простых к полю превращения, дамка стоит w.king простых
+struct NumberAndPotentialEval
+{
+    static constexpr bool uses_accumulator = false;
+
+    template <class P> static int score(const P& pos, const bool first_bot_color, const eval_weights& w)
+    {
+        return material_score(pos.men_count[0] + w.potential * pos.potential[0], pos.kings_count[0],
+                              pos.men_count[1] + w.potential * pos.potential[1], pos.kings_count[1], w.king,
+                              first_bot_color);
+    }
+};
+
+// Оценка пачки позиций по их маскам (например, всех потомков узла): слагаемые считает ядро,
+// оценка - та же функция оценки, поэтому результат совпадает с Eval::score для каждой позиции
+template <class Eval>
+void score_batch(const Position* pos, const size_t n, const bool first_bot_color, const eval_weights& w, int* out)
+{
+    constexpr size_t CHUNK = 64;
+    eval_terms terms[CHUNK];
+    for (size_t i = 0; i < n; i += CHUNK)
+    {
+        const size_t count = min(CHUNK, n - i);
+        eval_terms_batch(pos + i, count, terms);
+        for (size_t j = 0; j < count; ++j)
+            out[i + j] = Eval::score(terms[j], first_bot_color, w);
+    }
+}
@@ -0,0 +1,132 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Bitboard.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define EVAL_HAS_AVX2_PATH 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define EVAL_TARGET_AVX2 // MSVC разрешает интринсики AVX2 без флагов сборки
+#else
+#define EVAL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Ядро оценки по маскам: число простых, дамок и потенциал простых для пачки позиций.
+// Потенциал - взвешенная по строкам сумма числа простых; строка - это 4 бита маски, поэтому
+// число простых на каждой строке - popcount полубайта. Путь AVX2 считает 8 позиций за раз
+// (popcount полубайтов через таблицу vpshufb, взвешенная сумма - vpmaddubsw), скалярный путь -
+// эталон. Путь выбирается один раз по возможностям процессора.
+
+// Слагаемые оценки позиции (те же поля, что и счетчики Position)
+struct eval_terms
+{
+    int men_count[2], kings_count[2], potential[2];
+};
+
+// Скалярный путь
+inline void eval_terms_scalar(const Position* pos, const size_t n, eval_terms* out)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (int color = 0; color < 2; ++color)
+        {
+            const BB own = color ? pos[i].black : pos[i].white;
+            const BB men = own & ~pos[i].kings;
+            out[i].men_count[color] = pop_count(men);
+            out[i].kings_count[color] = pop_count(own & pos[i].kings);
+            int pot = 0;
+            for (int row = 0; row < 8; ++row)
+                pot += pop_count(men & row_mask(row)) * (color ? row : 7 - row);
+            out[i].potential[color] = pot;
+        }
+    }
+}
+
+#ifdef EVAL_HAS_AVX2_PATH
+// Есть ли AVX2 у процессора и поддержка регистров YMM у системы
+inline bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] >> 27) & 1, avx = (info[2] >> 28) & 1;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Сумма произведений байтов a (без знака) на байты w в каждой 32-битной дорожке
+EVAL_TARGET_AVX2 inline __m256i lane_dot(const __m256i a, const __m256i w)
+{
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(a, w), _mm256_set1_epi16(1));
+}
+
+// Путь AVX2: по 8 позиций в 32-битных дорожках
+EVAL_TARGET_AVX2 inline void eval_terms_avx2(const Position* pos, const size_t n, eval_terms* out)
+{
+    const __m256i nibble_lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    const __m256i ones8 = _mm256_set1_epi8(1);
+    // Веса строк в байтах дорожки: байт k - строки 2k (младший полубайт) и 2k + 1 (старший)
+    const __m256i white_low = _mm256_set1_epi32(0x01030507), white_high = _mm256_set1_epi32(0x00020406);
+    const __m256i black_low = _mm256_set1_epi32(0x06040200), black_high = _mm256_set1_epi32(0x07050301);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const Position* p = pos + i;
+        const __m256i white = _mm256_setr_epi32(int(p[0].white), int(p[1].white), int(p[2].white), int(p[3].white),
+                                                int(p[4].white), int(p[5].white), int(p[6].white), int(p[7].white));
+        const __m256i black = _mm256_setr_epi32(int(p[0].black), int(p[1].black), int(p[2].black), int(p[3].black),
+                                                int(p[4].black), int(p[5].black), int(p[6].black), int(p[7].black));
+        const __m256i kings = _mm256_setr_epi32(int(p[0].kings), int(p[1].kings), int(p[2].kings), int(p[3].kings),
+                                                int(p[4].kings), int(p[5].kings), int(p[6].kings), int(p[7].kings));
+        alignas(32) int32_t res[6][8];
+        for (int color = 0; color < 2; ++color)
+        {
+            const __m256i own = color ? black : white;
+            const __m256i men = _mm256_andnot_si256(kings, own);
+            const __m256i own_kings = _mm256_and_si256(kings, own);
+            const __m256i men_low = _mm256_shuffle_epi8(nibble_lut, _mm256_and_si256(men, low_nibbles));
+            const __m256i men_high = _mm256_shuffle_epi8(nibble_lut, _mm256_and_si256(_mm256_srli_epi32(men, 4), low_nibbles));
+            const __m256i kings_low = _mm256_shuffle_epi8(nibble_lut, _mm256_and_si256(own_kings, low_nibbles));
+            const __m256i kings_high =
+                _mm256_shuffle_epi8(nibble_lut, _mm256_and_si256(_mm256_srli_epi32(own_kings, 4), low_nibbles));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(res[color]), lane_dot(_mm256_add_epi8(men_low, men_high), ones8));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(res[2 + color]),
+                               lane_dot(_mm256_add_epi8(kings_low, kings_high), ones8));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(res[4 + color]),
+                               _mm256_add_epi32(lane_dot(men_low, color ? black_low : white_low),
+                                                lane_dot(men_high, color ? black_high : white_high)));
+        }
+        for (int j = 0; j < 8; ++j)
+            out[i + j] = { { res[0][j], res[1][j] }, { res[2][j], res[3][j] }, { res[4][j], res[5][j] } };
+    }
+    eval_terms_scalar(pos + i, n - i, out + i); // Остаток пачки
+}
+#endif
+
+// Слагаемые оценки для пачки позиций на лучшем доступном пути
+inline void eval_terms_batch(const Position* pos, const size_t n, eval_terms* out)
+{
+#ifdef EVAL_HAS_AVX2_PATH
+    static const bool avx2 = cpu_has_avx2();
+    if (avx2)
+    {
+        eval_terms_avx2(pos, n, out);
+        return;
+    }
+#endif
+    eval_terms_scalar(pos, n, out);
+}
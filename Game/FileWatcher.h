@@ -0,0 +1,82 @@
+﻿#pragma once
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Слежение за изменением файла без ожидания: на Linux через inotify (следим за каталогом, потому что
+// редакторы часто заменяют файл новым), на других системах - по времени последней записи
+class FileWatcher
+{
+public:
+    explicit FileWatcher(const string& path) : path(path)
+    {
+        const filesystem::path file(path);
+        name = file.filename().string();
+#ifdef __linux__
+        const string dir = file.has_parent_path() ? file.parent_path().string() : string(".");
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+        error_code ec;
+        last_write = filesystem::last_write_time(file, ec);
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            ::close(fd);
+#endif
+    }
+
+    // Был ли файл изменен с прошлой проверки
+    bool changed()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            bool res = false;
+            alignas(inotify_event) char buf[4096];
+            for (ssize_t len; (len = read(fd, buf, sizeof(buf))) > 0;) // Вычитываем все накопившиеся события
+            {
+                for (ssize_t i = 0; i < len;)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buf + i);
+                    res |= event->len && name == event->name;
+                    i += ssize_t(sizeof(inotify_event) + event->len);
+                }
+            }
+            return res;
+        }
+#endif
+        error_code ec;
+        const auto cur = filesystem::last_write_time(path, ec);
+        if (ec || cur == last_write)
+            return false;
+        last_write = cur;
+        return true;
+    }
+
+private:
+    string path; // Путь к файлу
+    string name; // Имя файла в каталоге
+    filesystem::file_time_type last_write; // Время последней записи при прошлой проверке
+#ifdef __linux__
+    int fd = -1; // Дескриптор inotify
+#endif
+};
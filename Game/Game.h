@@ -11,10 +11,12 @@
 class Game
 {
 public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game() : board(config.get().window.width, config.get().window.height), hand(&board), logic(&config)
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        logger.set_level(config.get().game.log_level);
+        if (!config.last_error().empty())  // Ошибки настроек: используются значения по умолчанию.
+            logger.warning("Settings error", { { "error", config.last_error() } });
+        log_load_errors();
     }
 
     // Основная функция для запуска игры.
@@ -23,8 +25,9 @@ public:
         auto start = chrono::steady_clock::now();  // Засекаем время начала игры.
         if (is_replay)  // Если это повтор игры, перезагружаем логику и настройки.
         {
-            logic = Logic(&board, &config);
-            config.reload();
+            reload_settings();
+            logic = Logic(&config);
+            log_load_errors();
             board.redraw();
         }
         else  // Иначе начинаем новую игру.
@@ -35,15 +38,19 @@ public:
 
         int turn_num = -1;  // Номер текущего хода.
         bool is_quit = false;  // Флаг для выхода из игры.
-        const int Max_turns = config("Game", "MaxNumTurns");  // Максимальное количество ходов из настроек.
-        while (++turn_num < Max_turns)  // Основной цикл игры.
+        const Settings& settings = config.get();  // Настройки, разобранные из файла.
+        while (++turn_num < settings.game.max_num_turns)  // Основной цикл игры.
         {
             beat_series = 0;  // Сбрасываем счётчик серии ударов.
-            logic.find_turns(turn_num % 2);  // Находим возможные ходы для текущего игрока.
-            if (logic.turns.empty())  // Если ходов нет, игра заканчивается.
+            if (config.changed() && reload_settings())  // Файл настроек изменен: применяем между ходами.
+            {
+                logic.apply_settings();
+                log_load_errors();
+            }
+            if (logic.find_turns(turn_num % 2, board.get_board()).empty())  // Если ходов нет, игра заканчивается.
                 break;
-            logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));  // Уровень сложности бота.
-            if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))  // Если игрок — человек.
+            logic.Max_depth = settings.bot.level[turn_num % 2];  // Уровень сложности бота.
+            if (!settings.bot.is_bot[turn_num % 2])  // Если игрок — человек.
             {
                 auto resp = player_turn(turn_num % 2);  // Ход игрока.
                 if (resp == Response::QUIT)  // Выход из игры.
@@ -58,8 +65,9 @@ public:
                 }
                 else if (resp == Response::BACK)  // Отмена хода.
                 {
-                    if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2)
+                    logic.stop_ponder();  // Предсказанный ход больше не нужен.
+                    if (settings.bot.is_bot[1 - turn_num % 2] &&
+                        !beat_series && board.history_size() > 1)
                     {
                         board.rollback();
                         --turn_num;
@@ -76,16 +84,14 @@ public:
                 bot_turn(turn_num % 2);  // Ход бота.
         }
         auto end = chrono::steady_clock::now();  // Засекаем время окончания игры.
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";  // Логируем время игры.
-        fout.close();
+        logger.info("Game time", { { "time_ms", (int)chrono::duration<double, milli>(end - start).count() } });  // Логируем время игры.
 
         if (is_replay)  // Если выбрана переигровка.
             return play();
         if (is_quit)  // Если игрок вышел.
             return 0;
         int res = 2;
-        if (turn_num == Max_turns)  // Если достигнут лимит ходов.
+        if (turn_num == settings.game.max_num_turns)  // Если достигнут лимит ходов.
         {
             res = 0;  // Ничья.
         }
@@ -108,11 +114,22 @@ private:
     void bot_turn(const bool color)
     {
         auto start = chrono::steady_clock::now();  // Засекаем время начала хода.
+        board.flush();  // Показываем последний ход соперника до начала поиска.
 
-        auto delay_ms = config("Bot", "BotDelayMS");  // Задержка хода бота.
+        const unsigned delay_ms = config.get().bot.delay_ms;  // Задержка хода бота.
         thread th(SDL_Delay, delay_ms);  // Задержка в отдельном потоке.
-        auto turns = logic.find_best_turns(color);  // Находим лучшие ходы.
+        auto turns = logic.find_best_turns(color, board.get_board());  // Находим лучшие ходы.
         th.join();
+        const string& stats_file = config.get().bot.search_stats;
+        if (!stats_file.empty())  // Статистика поиска: строка JSON на ход.
+        {
+            if (stats_file != stats_path)  // Файл открывается один раз, а не на каждый ход.
+            {
+                stats_path = stats_file;
+                stats_out = ofstream(project_path + stats_path, ios_base::app);
+            }
+            stats_out << logic.search_report(color, Position::from_mtx(board.get_board()), turns).dump() << "\n";
+        }
         bool is_first = true;
         for (auto turn : turns)  // Выполняем ходы.
         {
@@ -123,19 +140,55 @@ private:
             is_first = false;
             beat_series += (turn.xb != -1);  // Учитываем серию ударов.
             board.move_piece(turn, beat_series);  // Двигаем фигуру.
+            board.flush();  // Каждый шаг серии виден во время задержки.
         }
 
         auto end = chrono::steady_clock::now();  // Засекаем время окончания хода.
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";  // Логируем время хода.
-        fout.close();
+        const int time_ms = (int)chrono::duration<double, milli>(end - start).count();
+        if (logic.book_move)  // Ход взят из дебютной книги без поиска.
+            logger.info("Bot turn", { { "color", color ? "black" : "white" }, { "time_ms", time_ms }, { "book_move", true } });
+        else  // Глубина поиска, узлы, таблицы; ponder_hit - поиск начат на времени соперника.
+            logger.info("Bot turn", { { "color", color ? "black" : "white" },
+                                   { "time_ms", time_ms },
+                                   { "depth", logic.completed_depth },
+                                   { "nodes", logic.nodes },
+                                   { "tt_hits", logic.tt_hits },
+                                   { "tt_misses", logic.tt_misses },
+                                   { "tb_hits", logic.tb_hits },
+                                   { "ponder_hit", logic.ponder_hit } });
+
+        // Пока думает человек, бот ищет ответ на его предсказанный ход.
+        if (config.get().bot.ponder && !config.get().bot.is_bot[!color])
+            logic.start_ponder(color, board.get_board());
+    }
+
+    // Перечитывание файла настроек; при ошибке остаются прежние настройки, ошибка пишется в лог.
+    bool reload_settings()
+    {
+        if (config.reload())
+        {
+            logger.set_level(config.get().game.log_level);
+            return true;
+        }
+        logger.warning("Settings error", { { "error", config.last_error() } });
+        return false;
+    }
+
+    // Файлы бота не загружены: бот играет с весами по умолчанию или без нейросети.
+    void log_load_errors()
+    {
+        if (!logic.weights_error.empty())
+            logger.warning("Weights error", { { "error", logic.weights_error } });
+        if (!logic.nnue_error.empty())
+            logger.warning("Nnue error", { { "error", logic.nnue_error } });
     }
 
     // Функция для выполнения хода игрока.
     Response player_turn(const bool color)
     {
+        auto turns = logic.find_turns(color, board.get_board());  // Возможные ходы игрока.
         vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)  // Подсвечиваем возможные ходы.
+        for (auto turn : turns)  // Подсвечиваем возможные ходы.
         {
             cells.emplace_back(turn.x, turn.y);
         }
@@ -150,7 +203,7 @@ private:
             pair<POS_T, POS_T> cell{ get<1>(resp), get<2>(resp) };
 
             bool is_correct = false;
-            for (auto turn : logic.turns)  // Проверяем корректность выбора.
+            for (auto turn : turns)  // Проверяем корректность выбора.
             {
                 if (turn.x == cell.first && turn.y == cell.second)
                 {
@@ -182,7 +235,7 @@ private:
             board.clear_highlight();
             board.set_active(x, y);  // Подсвечиваем активную фигуру.
             vector<pair<POS_T, POS_T>> cells2;
-            for (auto turn : logic.turns)  // Подсвечиваем возможные ходы для выбранной фигуры.
+            for (auto turn : turns)  // Подсвечиваем возможные ходы для выбранной фигуры.
             {
                 if (turn.x == x && turn.y == y)
                 {
@@ -200,12 +253,12 @@ private:
         beat_series = 1;
         while (true)
         {
-            logic.find_turns(pos.x2, pos.y2);  // Ищем возможные удары.
-            if (!logic.have_beats)  // Если ударов больше нет, завершаем ход.
+            turns = logic.find_turns(pos.x2, pos.y2, board.get_board());  // Ищем возможные удары.
+            if (turns.empty() || turns[0].xb == -1)  // Если ударов больше нет, завершаем ход.
                 break;
 
             vector<pair<POS_T, POS_T>> cells;
-            for (auto turn : logic.turns)  // Подсвечиваем возможные удары.
+            for (auto turn : turns)  // Подсвечиваем возможные удары.
             {
                 cells.emplace_back(turn.x2, turn.y2);
             }
@@ -219,7 +272,7 @@ private:
                 pair<POS_T, POS_T> cell{ get<1>(resp), get<2>(resp) };
 
                 bool is_correct = false;
-                for (auto turn : logic.turns)  // Проверяем корректность выбора.
+                for (auto turn : turns)  // Проверяем корректность выбора.
                 {
                     if (turn.x2 == cell.first && turn.y2 == cell.second)
                     {
@@ -243,10 +296,13 @@ private:
     }
 
 private:
+    Logger& logger = Logger::instance();  // Лог игры (log.txt), создается до остальных полей.
     Config config;  // Конфигурация игры.
     Board board;    // Игровая доска.
     Hand hand;      // Управление вводом игрока.
     Logic logic;    // Логика игры.
     int beat_series;  // Счётчик серии ударов.
     bool is_replay = false;  // Флаг для переигровки.
+    string stats_path;  // Открытый файл статистики поиска.
+    ofstream stats_out;
 };
\ No newline at end of file
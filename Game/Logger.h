@@ -0,0 +1,408 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <initializer_list>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../Models/Project_path.h"
+
+using namespace std;
+
+// Асинхронный лог (log.txt). Вызов лога только копирует сообщение и поля в кольцевой буфер без блокировок
+// (ограниченная очередь Вьюкова: производители занимают ячейку через CAS), а форматирует и пишет в файл
+// фоновый поток, который держит файл открытым. Если буфер полон, запись отбрасывается, а число
+// отброшенных записей попадает в лог следующей строкой - вызывающий поток никогда не ждет.
+// Буфер дописывается в файл при выходе (деструктор) и при std::terminate. Обработчик аварийного сигнала
+// может сработать внутри malloc или самого лога, поэтому он только дописывает заранее подготовленную строку
+// об аварии через заранее открытый дескриптор файла (write); записи, не дошедшие до файла, теряются.
+//
+// Строка лога: время, уровень, сообщение и поля ключ=значение, например
+// 2026-10-18 12:00:00.123 INFO Bot turn time_ms=15 depth=7 nodes=10513
+
+// Уровень записи лога; записи ниже уровня лога не сохраняются
+enum class LogLevel
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Поле записи лога: ключ - строковый литерал, значение - целое, дробное, флаг или строка
+struct log_field
+{
+    enum class Type : uint8_t
+    {
+        Int,
+        Double,
+        Bool,
+        Text
+    };
+
+    template <class T, enable_if_t<is_integral_v<T> && !is_same_v<T, bool>, int> = 0>
+    log_field(const char* key, const T value) : key(key), type(Type::Int), i(static_cast<long long>(value))
+    {
+    }
+    log_field(const char* key, const double value) : key(key), type(Type::Double), d(value)
+    {
+    }
+    log_field(const char* key, const bool value) : key(key), type(Type::Bool), i(value)
+    {
+    }
+    log_field(const char* key, const string_view value) : key(key), type(Type::Text), text(value)
+    {
+    }
+    log_field(const char* key, const char* value) : key(key), type(Type::Text), text(value ? value : "")
+    {
+    }
+    log_field(const char* key, const string& value) : key(key), type(Type::Text), text(value)
+    {
+    }
+
+    const char* key;
+    Type type;
+    long long i = 0;
+    double d = 0;
+    string_view text;
+};
+
+class Logger
+{
+    static constexpr size_t MAX_FIELDS = 8; // Поля сверх этого числа отбрасываются
+    static constexpr size_t TEXT_SIZE = 256; // Сообщение и строковые поля записи; длиннее - обрезаются
+
+    // Ячейка буфера: запись копируется сюда целиком, строки - в text
+    struct log_record
+    {
+        atomic<size_t> seq; // Номер ячейки в очереди Вьюкова
+        LogLevel level;
+        uint8_t field_count;
+        uint16_t message_size;
+        chrono::system_clock::time_point time;
+        struct
+        {
+            const char* key;
+            log_field::Type type;
+            uint16_t offset, size; // Строка значения в text
+            long long i;
+            double d;
+        } fields[MAX_FIELDS];
+        char text[TEXT_SIZE];
+    };
+
+public:
+    // capacity - число записей буфера (округляется вверх до степени двойки)
+    explicit Logger(const string& path, const size_t capacity = 1024)
+        : ring(ring_size(capacity)), mask(ring.size() - 1), out(path, ios_base::trunc)
+    {
+        for (size_t i = 0; i < ring.size(); ++i)
+            ring[i].seq.store(i, memory_order_relaxed);
+        writer = thread([this] { writer_loop(); });
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ~Logger()
+    {
+        stopping.store(true);
+        writer.join(); // Поток дописывает буфер перед выходом
+        if (crash_logger() == this)
+            crash_logger() = nullptr;
+    }
+
+    // Общий лог игры в log.txt; при первом вызове ставятся обработчики аварийного завершения
+    static Logger& instance()
+    {
+        static Logger logger(project_path + "log.txt");
+        static const bool handlers = install_crash_handlers(&logger, project_path + "log.txt");
+        (void)handlers;
+        return logger;
+    }
+
+    void set_level(const LogLevel level)
+    {
+        min_level.store(int(level), memory_order_relaxed);
+    }
+
+    bool enabled(const LogLevel level) const
+    {
+        return int(level) >= min_level.load(memory_order_relaxed);
+    }
+
+    // Запись в лог: копирование в буфер, формат и файл - в фоновом потоке
+    void log(const LogLevel level, const string_view message, const initializer_list<log_field> fields = {})
+    {
+        if (!enabled(level))
+            return;
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        log_record* rec;
+        while (true)
+        {
+            rec = &ring[pos & mask];
+            const size_t seq = rec->seq.load(memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) // Буфер полон
+            {
+                dropped.fetch_add(1, memory_order_relaxed);
+                return;
+            }
+            else
+                pos = enqueue_pos.load(memory_order_relaxed);
+        }
+
+        rec->level = level;
+        rec->time = chrono::system_clock::now();
+        size_t used = copy_text(rec->text, 0, message);
+        rec->message_size = uint16_t(used);
+        uint8_t count = 0;
+        for (const auto& field : fields)
+        {
+            if (count == MAX_FIELDS)
+                break;
+            auto& f = rec->fields[count++];
+            f.key = field.key;
+            f.type = field.type;
+            f.i = field.i;
+            f.d = field.d;
+            f.offset = uint16_t(used);
+            used = copy_text(rec->text, used, field.text);
+            f.size = uint16_t(used - f.offset);
+        }
+        rec->field_count = count;
+        rec->seq.store(pos + 1, memory_order_release);
+    }
+
+    void debug(const string_view message, const initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::Debug, message, fields);
+    }
+
+    void info(const string_view message, const initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::Info, message, fields);
+    }
+
+    void warning(const string_view message, const initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::Warning, message, fields);
+    }
+
+    void error(const string_view message, const initializer_list<log_field> fields = {})
+    {
+        log(LogLevel::Error, message, fields);
+    }
+
+    // Запись буфера в файл из вызывающего потока (фоновый поток в это время пропускает свой проход)
+    void flush()
+    {
+        drain();
+    }
+
+private:
+    static size_t ring_size(const size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size *= 2;
+        return size;
+    }
+
+    static size_t copy_text(char* text, const size_t used, const string_view str)
+    {
+        const size_t size = min(str.size(), TEXT_SIZE - used);
+        memcpy(text + used, str.data(), size);
+        return used + size;
+    }
+
+    void writer_loop()
+    {
+        while (!stopping.load())
+        {
+            if (!drain())
+                this_thread::sleep_for(chrono::milliseconds(2)); // Буфер пуст: вызовы лога не будят поток
+        }
+        drain();
+    }
+
+    // Запись всех готовых записей буфера; false, если писать было нечего
+    bool drain()
+    {
+        if (draining.exchange(true, memory_order_acquire)) // Буфер уже пишет другой поток
+            return false;
+        bool written = false;
+        while (true)
+        {
+            log_record& rec = ring[dequeue_pos & mask];
+            if (rec.seq.load(memory_order_acquire) != dequeue_pos + 1)
+                break;
+            write(rec);
+            rec.seq.store(dequeue_pos + mask + 1, memory_order_release);
+            ++dequeue_pos;
+            written = true;
+        }
+        const size_t lost = dropped.exchange(0, memory_order_relaxed);
+        if (lost)
+            out << "Log buffer overflow: " << lost << " records dropped\n";
+        if (written || lost)
+            out.flush();
+        draining.store(false, memory_order_release);
+        return written;
+    }
+
+    void write(const log_record& rec)
+    {
+        static const char* const level_names[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+        const time_t t = chrono::system_clock::to_time_t(rec.time);
+        tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &t);
+#else
+        localtime_r(&t, &local);
+#endif
+        const auto ms = chrono::duration_cast<chrono::milliseconds>(rec.time.time_since_epoch()).count() % 1000;
+        out << put_time(&local, "%Y-%m-%d %H:%M:%S") << '.' << setw(3) << setfill('0') << ms << setfill(' ') << ' '
+            << level_names[int(rec.level)] << ' ';
+        out.write(rec.text, rec.message_size);
+        for (uint8_t i = 0; i < rec.field_count; ++i)
+        {
+            const auto& f = rec.fields[i];
+            out << ' ' << f.key << '=';
+            switch (f.type)
+            {
+            case log_field::Type::Int:
+                out << f.i;
+                break;
+            case log_field::Type::Double:
+                out << f.d;
+                break;
+            case log_field::Type::Bool:
+                out << (f.i ? "true" : "false");
+                break;
+            case log_field::Type::Text:
+                out << '"';
+                out.write(rec.text + f.offset, f.size);
+                out << '"';
+                break;
+            }
+        }
+        out << '\n';
+    }
+
+    // Лог, который дописывается при аварийном завершении
+    static Logger*& crash_logger()
+    {
+        static Logger* logger = nullptr;
+        return logger;
+    }
+
+    // Запись буфера и сообщения об аварии при std::terminate: если буфер пишет фоновый поток, ждем его
+    // недолго (он мог упасть сам); буфер пишется до сообщения, чтобы для него нашлось место
+    void crash_drain(const string_view message, const initializer_list<log_field> fields)
+    {
+        for (int i = 0; i < 100 && draining.load(); ++i)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        drain();
+        error(message, fields);
+        drain();
+    }
+
+    // Строка об аварийном сигнале, подготовленная при установке обработчиков
+    struct crash_message
+    {
+        int sig;
+        char text[64];
+        size_t size;
+    };
+
+    static crash_message (&crash_messages())[4]
+    {
+        static crash_message messages[4] = {};
+        return messages;
+    }
+
+    // Дескриптор файла лога для обработчика сигналов (открыт с дозаписью в конец)
+    static int& crash_fd()
+    {
+        static int fd = -1;
+        return fd;
+    }
+
+    // Обработчик аварийного сигнала: только функции, безопасные в обработчике (write, signal, raise)
+    static void on_crash_signal(const int sig)
+    {
+        const int fd = crash_fd();
+        for (const auto& message : crash_messages())
+            if (message.sig == sig && fd != -1)
+            {
+#ifdef _WIN32
+                (void)_write(fd, message.text, unsigned(message.size));
+#else
+                (void)::write(fd, message.text, message.size);
+#endif
+            }
+        signal(sig, SIG_DFL); // Дальше - обычное аварийное завершение
+        raise(sig);
+    }
+
+    static bool install_crash_handlers(Logger* logger, const string& path)
+    {
+        crash_logger() = logger;
+#ifdef _WIN32
+        crash_fd() = _open(path.c_str(), _O_WRONLY | _O_APPEND);
+#else
+        crash_fd() = open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+#endif
+        const pair<int, const char*> signals[] = { { SIGSEGV, "SIGSEGV" }, { SIGABRT, "SIGABRT" }, { SIGFPE, "SIGFPE" },
+                                                   { SIGILL, "SIGILL" } };
+        for (size_t i = 0; i < size(signals); ++i)
+        {
+            auto& message = crash_messages()[i];
+            message.sig = signals[i].first;
+            const int size = snprintf(message.text, sizeof(message.text), "ERROR Crash signal=%s\n", signals[i].second);
+            message.size = size_t(max(size, 0));
+            signal(signals[i].first, on_crash_signal);
+        }
+        set_terminate([] {
+            if (Logger* logger = crash_logger())
+                logger->crash_drain("Terminate: unhandled exception", {});
+            abort();
+        });
+        return true;
+    }
+
+    vector<log_record> ring; // Кольцевой буфер записей
+    size_t mask = 0;
+    atomic<size_t> enqueue_pos{ 0 }; // Следующая ячейка для записи (общая для всех потоков)
+    size_t dequeue_pos = 0; // Следующая ячейка для чтения (только под draining)
+    atomic<bool> draining{ false }; // Буфер пишет какой-то поток
+    atomic<size_t> dropped{ 0 }; // Записи, отброшенные при полном буфере
+    atomic<int> min_level{ int(LogLevel::Info) };
+    atomic<bool> stopping{ false };
+    ofstream out;
+    thread writer;
+};
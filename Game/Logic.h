@@ -1,340 +1,938 @@
 ﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <future>
+#include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
+#include "Bitboard.h"
+#include "Book.h"
 #include "Config.h"
+#include "Eval.h"
+#include "Nnue.h"
+#include "SearchStats.h"
+#include "TT.h"
+#include "Tablebase.h"
+#include "Weights.h"
 
-const int INF = 1e9; // Бесконечность для алгоритма
+// Политики отсечений поиска: параметр шаблона поиска вместе с оценкой позиции
+struct FullSearch // O0: полный минимакс без отсечений, таблицы транспозиций и сортировки ходов
+{
+    static constexpr bool alpha_beta = false;
+};
+
+struct AlphaBetaSearch // O1, O2: альфа-бета отсечения, таблица транспозиций, сортировка ходов
+{
+    static constexpr bool alpha_beta = true;
+};
 
 class Logic
 {
 public:
-    // Конструктор: инициализация доски, конфига, генератора случайных чисел
-    Logic(Board* board, Config* config) : board(board), config(config)
+    // Конструктор: инициализация конфига, генератора случайных чисел.
+    // Логика не зависит от доски и SDL: позиция передается в каждый вызов.
+    Logic(Config* config) : config(config)
+    {
+        rand_eng = std::default_random_engine(!config->get().bot.no_random ? unsigned(time(0)) : 0);
+        tt = make_shared<TranspositionTable>(); // Таблица транспозиций, общая для всех потоков
+        abort_search = make_shared<atomic<bool>>(false);
+        apply_settings();
+    }
+
+    // Применение настроек бота из конфига (при создании и после перезагрузки настроек между ходами).
+    // Поиск дальше работает только с разобранными значениями.
+    void apply_settings()
     {
-        rand_eng = std::default_random_engine(
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
-        scoring_mode = (*config)("Bot", "BotScoringType"); // Режим подсчета очков
-        optimization = (*config)("Bot", "Optimization"); // Режим оптимизации
+        stop_ponder(); // Размышление использует таблицу транспозиций, которая может быть пересоздана
+        const auto& bot = config->get().bot;
+        no_random = bot.no_random;
+        if (bot.nnue != nnue_path) // Файл нейросетевой оценки
+        {
+            nnue_path = bot.nnue;
+            nnue.reset();
+            nnue_load_error = "the \"Nnue\" setting is empty";
+            auto loaded_nnue = make_shared<Nnue>();
+            if (!nnue_path.empty() && loaded_nnue->load(project_path + nnue_path, nnue_load_error))
+                nnue = loaded_nnue;
+        }
+        if (bot.weights != weights_path) // Файл весов оценок
+        {
+            weights_path = bot.weights;
+            weights = eval_weights();
+            weights_error.clear();
+            if (!weights_path.empty())
+                load_eval_weights(project_path + weights_path, weights, weights_error);
+        }
+        scoring_mode = bot.scoring; // Режим подсчета очков
+        nnue_error.clear();
+        if (scoring_mode == ScoringType::Nnue && !nnue) // Без файла сети - оценка по фигурам и потенциалу
+        {
+            scoring_mode = ScoringType::NumberAndPotential;
+            nnue_error = nnue_load_error;
+        }
+        search = select_search(scoring_mode, bot.optimization); // Поиск под режимы подсчета и оптимизации
+        aspiration = bot.optimization != Optimization::O0; // Окна аспирации - только с отсечениями
+        if (bot.tt_size_mb != tt_size_mb)
+        {
+            tt_size_mb = bot.tt_size_mb;
+            tt->resize(tt_size_mb);
+        }
+        time_budget_ms = bot.time_ms; // Бюджет времени на ход
+        node_budget = bot.nodes; // Бюджет узлов на ход
+        threads = bot.threads; // Число потоков поиска
+        if (threads <= 0)
+            threads = max(1, int(thread::hardware_concurrency()));
+        if (bot.tablebase != tablebase_path) // Файл эндшпильных таблиц
+        {
+            tablebase_path = bot.tablebase;
+            tablebase.reset();
+            auto loaded = make_shared<Tablebase>(); // Таблицы отображаются в память один раз на все потоки
+            if (!tablebase_path.empty() && loaded->load(project_path + tablebase_path))
+                tablebase = loaded; // Без файла таблиц эндшпиль просчитывается обычным поиском
+        }
+        if (bot.book != book_path) // Файл дебютной книги
+        {
+            book_path = bot.book;
+            book.reset();
+            auto loaded_book = make_shared<OpeningBook>();
+            if (!book_path.empty() && loaded_book->load(project_path + book_path))
+                book = loaded_book;
+        }
     }
 
-    // Поиск лучших ходов для текущего цвета
-    vector<move_pos> find_best_turns(const bool color)
+    // Начало новой партии тем же ботом: таблица транспозиций, накопленное время и генератор случайных
+    // чисел сбрасываются, а загруженные таблицы, книга, веса и сеть остаются
+    void new_game()
     {
-        next_best_state.clear(); // Очистка состояний
-        next_move.clear(); // Очистка ходов
+        stop_ponder();
+        tt->clear();
+        time_bank_ms[0] = time_bank_ms[1] = 0;
+        rand_eng.seed(!no_random ? unsigned(time(0)) : 0);
+    }
 
-        // Запуск рекурсивного поиска лучшего хода
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
+    // Поиск лучших ходов для текущего цвета.
+    // При нескольких потоках (Lazy SMP) помощники ищут ту же позицию со своим случайным порядком
+    // равных ходов в корне и своей начальной глубиной, заполняя общую таблицу транспозиций;
+    // ход берется из поиска главного потока.
+    vector<move_pos> find_best_turns(const bool color, const vector<vector<POS_T>>& mtx)
+    {
+        return find_best_turns(color, Position::from_mtx(mtx));
+    }
 
-        // Формирование последовательности ходов
-        int cur_state = 0;
-        vector<move_pos> res;
-        do {
-            res.push_back(next_move[cur_state]); // Добавление хода в результат
-            cur_state = next_best_state[cur_state]; // Переход к следующему состоянию
-        } while (cur_state != -1 && next_move[cur_state].x != -1); // Пока есть ходы
+    vector<move_pos> find_best_turns(const bool color, const Position& pos)
+    {
+        // Если соперник сделал предсказанный ход, используется поиск, начатый на его времени;
+        // иначе этот поиск отменяется, а найденное им остается в таблице транспозиций
+        ponder_hit = false;
+        if (ponder)
+        {
+            const auto state = move(ponder);
+            if (state->color == color && state->pos == pos)
+                return finish_ponder(*state, color);
+        }
+
+        // Ход из дебютной книги делается без поиска, а сэкономленный бюджет времени
+        // переходит на следующие ходы этого цвета. Книга используется только детерминированным ботом
+        // не ниже ее уровня: иначе она заменила бы случайный выбор равных ходов и слабую игру легких уровней
+        vector<bit_move> book_turns;
+        book_move = book && no_random && Max_depth >= book->level() && book->probe(pos, color, book_turns);
+        if (book_move)
+        {
+            nodes = tt_hits = tt_misses = tb_hits = 0;
+            stats = search_stats();
+            time_bank_ms[color] += time_budget_ms;
+            vector<move_pos> res;
+            for (auto turn : book_turns)
+                res.push_back(turn.to_move_pos());
+            return res;
+        }
+        const long long extra_ms = time_bank_ms[color] / 2; // Половина накопленного времени - на этот ход
+        time_bank_ms[color] -= extra_ms;
+        move_budget_ms = time_budget_ms ? time_budget_ms + extra_ms : 0;
+
+        vector<Logic> helpers(threads - 1, *this);
+        vector<thread> pool;
+        for (int i = 0; i < threads - 1; ++i)
+        {
+            helpers[i].rand_eng.seed(unsigned(rand_eng()) + i);
+            helpers[i].move_budget_ms = 0; // Помощники останавливаются по сигналу главного потока
+            helpers[i].node_budget = 0;
+            helpers[i].ponder_node_budget.reset();
+            pool.emplace_back([&helper = helpers[i], pos, color, i] { helper.iterate(pos, color, i % 2 + 1); });
+        }
+        auto res = iterate(pos, color, 0);
+        abort_search->store(true);
+        for (auto& th : pool)
+            th.join();
+        abort_search->store(false); // Сигнал сбрасывается после поиска: остановка извне до начала поиска не теряется
+        for (auto& helper : helpers) // Статистика по всем потокам
+        {
+            nodes += helper.nodes;
+            tt_hits += helper.tt_hits;
+            tt_misses += helper.tt_misses;
+            tb_hits += helper.tb_hits;
+            stats.add(helper.stats);
+        }
         return res;
     }
 
+    // Размышление на времени соперника: после хода бота цвета color (позиция mtx, ходит соперник)
+    // в фоне начинается поиск ответа на ход соперника, предсказанный таблицей транспозиций
+    void start_ponder(const bool color, const vector<vector<POS_T>>& mtx)
+    {
+        start_ponder(color, Position::from_mtx(mtx));
+    }
+
+    void start_ponder(const bool color, const Position& pos)
+    {
+        ponder.reset(); // Прошлое размышление останавливается
+        auto state = make_shared<ponder_search>();
+        state->pos = pos;
+        state->color = color;
+        if (!play_tt_move(state->pos, !color, 0)) // Предсказанный ход соперника
+            return;
+
+        state->logic = make_unique<Logic>(*this);
+        Logic& logic = *state->logic;
+        logic.abort_search = make_shared<atomic<bool>>(false); // Своя остановка у размышления и его помощников
+        logic.time_budget_ms = 0; // Бюджеты начинают действовать после хода соперника
+        logic.time_bank_ms[color] = 0;
+        logic.ponder_node_budget = make_shared<atomic<size_t>>(0);
+        state->result = async(launch::async, [&logic, pos = state->pos, color] { return logic.find_best_turns(color, pos); });
+        ponder = state;
+    }
+
+    // Остановка размышления (например, при отмене хода)
+    void stop_ponder()
+    {
+        ponder.reset();
+    }
+
+    // Позиция, для которой идет размышление (после предсказанного хода соперника); false, если размышления нет
+    bool ponder_position(Position& pos) const
+    {
+        if (!ponder)
+            return false;
+        pos = ponder->pos;
+        return true;
+    }
+
 private:
-    // Выполнение хода на доске
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
+    // Размышление на времени соперника: копия логики, позиция после предсказанного хода и результат поиска
+    struct ponder_search
+    {
+        unique_ptr<Logic> logic;
+        Position pos;
+        bool color = false;
+        future<vector<move_pos>> result;
+
+        ~ponder_search()
+        {
+            if (result.valid())
+            {
+                logic->abort_search->store(true);
+                result.wait();
+            }
+        }
+    };
+
+    // Завершение размышления после предсказанного хода соперника: поиск получает обычный бюджет времени
+    // и узлов (узлы считаются с начала размышления), а без бюджета досчитывает уровень бота
+    vector<move_pos> finish_ponder(ponder_search& state, const bool color)
+    {
+        const long long extra_ms = time_bank_ms[color] / 2;
+        time_bank_ms[color] -= extra_ms;
+        state.logic->ponder_node_budget->store(node_budget);
+        if (time_budget_ms)
+        {
+            state.result.wait_for(chrono::milliseconds(time_budget_ms + extra_ms));
+            state.logic->abort_search->store(true);
+        }
+        auto res = state.result.get();
+        const Logic& logic = *state.logic;
+        completed_depth = logic.completed_depth;
+        nodes = logic.nodes;
+        tt_hits = logic.tt_hits;
+        tt_misses = logic.tt_misses;
+        tb_hits = logic.tb_hits;
+        stats = logic.stats;
+        pv_line = logic.pv_line;
+        book_move = logic.book_move;
+        ponder_hit = true;
+        return res;
+    }
+
+    // Ход из таблицы транспозиций для позиции pos (ходит color, depth - номер хода от корня поиска)
+    // делается в pos целиком: шаг из таблицы, серия взятий продолжается первым возможным взятием.
+    // false, если позиции нет в таблице или ход в ней невозможен
+    bool play_tt_move(Position& pos, const bool color, const size_t depth) const
     {
-        if (turn.xb != -1) // Если есть взятие
-            mtx[turn.xb][turn.yb] = 0; // Удаляем фигуру противника
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7)) // Превращение в дамку
-            mtx[turn.x][turn.y] += 2;
-        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y]; // Перемещение фигуры
-        mtx[turn.x][turn.y] = 0; // Очистка старой позиции
-        return mtx;
+        tt_entry entry;
+        if (!tt->probe(tt_key(pos, color, depth), entry))
+            return false;
+        const Position before = pos;
+        MoveList turns;
+        const bool have_beats = gen_turns(pos, color, turns);
+        bit_move turn = entry.move;
+        while (find(turns.begin(), turns.end(), turn) != turns.end())
+        {
+            make_turn(pos, turn);
+            if (!have_beats || !gen_piece_turns(pos, turn.to, turns))
+                break;
+            turn = turns[0];
+        }
+        return !(pos == before);
+    }
+
+    // Ключ таблицы транспозиций: оценки за разные стороны бота не смешиваются
+    static uint64_t tt_key(const Position& pos, const bool color, const size_t depth)
+    {
+        return zobrist.hash(pos, color) ^ ((depth % 2 == color) ? zobrist.perspective : 0);
     }
 
-    // Подсчет очков для текущего состояния доски
-    double calc_score(const vector<vector<POS_T>>& mtx, const bool first_bot_color) const
+    // Итеративное углубление: глубина растет на 1 от first_depth до Max_depth или до исчерпания бюджета,
+    // результатом служит ход последней полностью просчитанной глубины.
+    vector<move_pos> iterate(Position pos, const bool color, const size_t first_depth)
     {
-        double w = 0, wq = 0, b = 0, bq = 0; // Счетчики фигур и дамок
-        for (POS_T i = 0; i < 8; ++i)
+        start_time = chrono::steady_clock::now();
+        nodes = 0;
+        tt_hits = tt_misses = 0; // Статистика таблиц считается для каждого хода
+        tb_hits = 0;
+        stats = search_stats();
+        capture_chain = 0;
+        stop = false;
+        killers.assign(Max_depth + 1, {}); // Ходы-убийцы и история набираются заново для каждого хода
+        for (auto& from_turns : history)
+            for (auto& to_turns : from_turns)
+                fill(begin(to_turns), end(to_turns), 0);
+        pv_move = bit_move();
+        pv_line.clear();
+        pv_ply = 0;
+
+        vector<move_pos> res;
+        int last_score = 0; // Оценка последней досчитанной глубины
+        for (search_depth = first_depth; search_depth <= size_t(Max_depth); ++search_depth)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            // Окно аспирации вокруг оценки прошлой глубины; если оценка вышла за окно,
+            // глубина просчитывается заново с окном, расширенным в эту сторону
+            int alpha = -INF, beta = INF, delta = ASPIRATION_WINDOW;
+            if (aspiration && search_depth > first_depth && abs(last_score) < WIN_SCORE / 2)
+            {
+                alpha = last_score - delta;
+                beta = last_score + delta;
+            }
+            const size_t depth_start_nodes = nodes;
+            const double depth_start_ms = elapsed_ms_precise();
+            int score;
+            while (true)
             {
-                w += (mtx[i][j] == 1); // Белые фигуры
-                wq += (mtx[i][j] == 3); // Белые дамки
-                b += (mtx[i][j] == 2); // Черные фигуры
-                bq += (mtx[i][j] == 4); // Черные дамки
-                if (scoring_mode == "NumberAndPotential") // Учет потенциала фигур
+                if (scoring_mode == ScoringType::Nnue) // Аккумулятор корня; дальше он обновляется на каждом шаге
                 {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i); // Потенциал белых
-                    b += 0.05 * (mtx[i][j] == 2) * (i); // Потенциал черных
+                    nnue_stack.resize(1);
+                    nnue->refresh(pos, nnue_stack[0]);
                 }
+                next_best_state.clear(); // Очистка состояний
+                next_move.clear(); // Очистка ходов
+
+                // Запуск рекурсивного поиска лучшего хода
+                score = (this->*search)(pos, color, -1, 0, alpha, beta);
+                if (stop || (score > alpha && score < beta))
+                    break;
+                ++stats.aspiration_researches;
+                delta *= 4;
+                if (score <= alpha)
+                    alpha = delta > ASPIRATION_MAX ? -INF : score - delta;
+                else
+                    beta = delta > ASPIRATION_MAX ? INF : score + delta;
             }
+            if (stop) // Глубина не досчитана - остается результат предыдущей
+                break;
+            last_score = score;
+            stats.depth_nodes.push_back(nodes - depth_start_nodes);
+            stats.depth_ms.push_back(elapsed_ms_precise() - depth_start_ms);
+
+            // Формирование последовательности ходов
+            pv_move = next_move[0]; // Лучший ход этой глубины просчитывается первым на следующей
+            pv_line = pv_table[0];
+            res.clear();
+            int cur_state = 0;
+            do {
+                res.push_back(next_move[cur_state].to_move_pos()); // Добавление хода в результат
+                cur_state = next_best_state[cur_state]; // Переход к следующему состоянию
+            } while (cur_state != -1 && next_move[cur_state].from != -1); // Пока есть ходы
+            completed_depth = int(search_depth);
+
+            // Следующая глубина дороже всех предыдущих вместе, поэтому ее не начинаем,
+            // если уже израсходована половина бюджета
+            const size_t budget_nodes = current_node_budget();
+            if ((move_budget_ms && elapsed_ms() * 2 >= move_budget_ms) || (budget_nodes && nodes * 2 >= budget_nodes))
+                break;
         }
-        if (!first_bot_color) // Если бот играет за черных
+        stats.time_ms = elapsed_ms_precise();
+        return res;
+    }
+
+public:
+    // Подсчет очков для текущего состояния доски (поиск вызывает оценку своего режима напрямую)
+    int calc_score(const Position& pos, const bool first_bot_color) const
+    {
+        if (scoring_mode == ScoringType::Nnue)
         {
-            swap(b, w);
-            swap(bq, wq);
+            nnue_accumulator acc;
+            nnue->refresh(pos, acc);
+            return nnue->score(acc, pos, first_bot_color);
         }
-        if (w + wq == 0) // Если белых нет
-            return INF;
-        if (b + bq == 0) // Если черных нет
-            return 0;
-        int q_coef = 4; // Коэффициент для дамок
-        if (scoring_mode == "NumberAndPotential")
+        if (scoring_mode == ScoringType::NumberAndPotential)
+            return NumberAndPotentialEval::score(pos, first_bot_color, weights);
+        return NumberOnlyEval::score(pos, first_bot_color, weights);
+    }
+
+    // Подсчет очков для пачки позиций по маскам (счетчики позиций не нужны)
+    void calc_scores(const Position* pos, const size_t n, const bool first_bot_color, int* out) const
+    {
+        if (scoring_mode == ScoringType::Nnue)
         {
-            q_coef = 5; // Увеличенный коэффициент
+            for (size_t i = 0; i < n; ++i)
+            {
+                Position cur = pos[i];
+                cur.refresh();
+                out[i] = calc_score(cur, first_bot_color);
+            }
         }
-        return (b + bq * q_coef) / (w + wq * q_coef); // Возвращаем оценку
+        else if (scoring_mode == ScoringType::NumberAndPotential)
+            score_batch<NumberAndPotentialEval>(pos, n, first_bot_color, weights, out);
+        else
+            score_batch<NumberOnlyEval>(pos, n, first_bot_color, weights, out);
+    }
+
+private:
+    static constexpr int ASPIRATION_WINDOW = 50; // Начальная половина окна аспирации (около 5% материала)
+    static constexpr int ASPIRATION_MAX = 3200; // Окно шире - поиск без границы с этой стороны
+
+    typedef int (Logic::*search_fn)(Position&, bool, int, size_t, int, int);
+
+    // Выбор специализации поиска один раз при применении настроек: в самом поиске проверок режима нет
+    static search_fn select_search(const ScoringType scoring, const Optimization optimization)
+    {
+        if (scoring == ScoringType::Nnue)
+            return select_pruning<NnueEval>(optimization);
+        if (scoring == ScoringType::NumberAndPotential)
+            return select_pruning<NumberAndPotentialEval>(optimization);
+        return select_pruning<NumberOnlyEval>(optimization);
+    }
+
+    template <class Eval> static search_fn select_pruning(const Optimization optimization)
+    {
+        if (optimization == Optimization::O0)
+            return &Logic::find_first_best_turn<Eval, FullSearch>;
+        return &Logic::find_first_best_turn<Eval, AlphaBetaSearch>;
     }
 
-    // Рекурсивный поиск лучшего хода (первый уровень)
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state, double alpha = -1)
+    // Рекурсивный поиск лучшего хода (первый уровень): узел максимума с окном (alpha, beta).
+    // С отсечениями первый ход считается с полным окном, остальные - с нулевым окном (best, best + 1),
+    // и только ход, который его превысил, пересчитывается с полным окном (PVS)
+    template <class Eval, class Prune>
+    int find_first_best_turn(Position& pos, const bool color, const int sq, size_t state, const int alpha, const int beta)
     {
+        const size_t ply = pv_enter();
         next_best_state.push_back(-1); // Инициализация состояния
-        next_move.emplace_back(-1, -1, -1, -1); // Инициализация хода
-        double best_score = -1; // Лучший счет
+        next_move.emplace_back(); // Инициализация хода
+        int best_score = -INF; // Лучший счет
 
         // Поиск всех возможных ходов для текущего состояния
+        MoveList turns_now; // Текущие ходы (на стеке)
+        bool have_beats_now; // Есть ли взятия
         if (state != 0)
-            find_turns(x, y, mtx);
-        auto turns_now = turns; // Текущие ходы
-        bool have_beats_now = have_beats; // Есть ли взятия
+            have_beats_now = gen_piece_turns(pos, sq, turns_now);
+        else
+        {
+            // Случайный выбор среди равных ходов только в корне: перемешивание до устойчивой сортировки
+            have_beats_now = gen_turns(pos, color, turns_now);
+            shuffle(turns_now.begin(), turns_now.end(), rand_eng);
+            order_turns(pos, color, 0, pv_move, turns_now);
+        }
 
         // Если нет взятий и это не начальное состояние, переходим к следующему уровню
         if (!have_beats_now && state != 0) {
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+            ++pv_ply;
+            const int score = find_best_turns_rec<Eval, Prune>(pos, 1 - color, 0, alpha, beta);
+            --pv_ply;
+            pv_table[ply] = pv_table[ply + 1];
+            return score;
         }
 
         // Перебор всех возможных ходов
+        bool first_turn = true;
         for (auto turn : turns_now) {
             size_t next_state = next_move.size();
-            double score;
+            const int low = max(alpha, best_score); // Ход лучше найденного должен превысить low
+            int score;
 
             // Если есть взятия, продолжаем поиск
+            const undo_info undo = make_turn(pos, turn);
+            eval_make<Eval>(pos, turn, undo);
+            const int chain = capture_chain;
+            ++pv_ply;
             if (have_beats_now) {
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, next_state, best_score);
+                count_capture(state == 0);
+                score = find_first_best_turn<Eval, Prune>(pos, color, turn.to, next_state, low, beta);
+            }
+            else if (!Prune::alpha_beta || first_turn) {
+                score = find_best_turns_rec<Eval, Prune>(pos, 1 - color, 0, low, beta);
             }
             else {
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+                score = find_best_turns_rec<Eval, Prune>(pos, 1 - color, 0, low, low + 1);
+                if (score > low && score < beta && !stop) {
+                    ++stats.pvs_researches;
+                    score = find_best_turns_rec<Eval, Prune>(pos, 1 - color, 0, low, beta);
+                }
             }
+            --pv_ply;
+            capture_chain = chain;
+            eval_unmake<Eval>();
+            unmake_turn(pos, turn, undo);
+
+            if (stop) // Бюджет исчерпан, оценка недостоверна
+                return best_score;
 
             // Обновление лучшего счета
             if (score > best_score) {
                 best_score = score;
                 next_best_state[state] = (have_beats_now ? int(next_state) : -1);
                 next_move[state] = turn;
+                pv_update(ply, turn);
             }
+            if (Prune::alpha_beta && best_score >= beta) // Выше окна аспирации: глубина будет пересчитана
+                break;
+            first_turn = false;
         }
         return best_score; // Возврат лучшего счета
     }
 
-    // Рекурсивный поиск ходов с альфа-бета отсечением
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1, double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
+    // Рекурсивный поиск ходов с альфа-бета отсечением (минимакс: на нечетной глубине ходит бот - максимум).
+    // Как и на первом уровне, после первого хода остальные проверяются нулевым окном у границы,
+    // которую они должны улучшить: alpha в узле максимума, beta в узле минимума
+    template <class Eval, class Prune>
+    int find_best_turns_rec(Position& pos, const bool color, const size_t depth, int alpha = -INF, int beta = INF, const int sq = -1)
     {
-        if (depth == Max_depth) // Если достигнута максимальная глубина
+        const size_t ply = pv_enter();
+        // Проверка бюджета; нулевая глубина всегда досчитывается, чтобы был хотя бы один ход
+        if ((++nodes & 1023) == 0 && search_depth > 0)
+            check_budget();
+        if (stop)
+            return 0;
+
+        // Позиция из эндшпильных таблиц оценивается точно, без поиска (только в начале хода)
+        tb_result tb;
+        if (sq == -1 && tablebase && tablebase->probe(pos, color, tb))
+        {
+            ++tb_hits;
+            return tb_score(tb, depth % 2 == 1);
+        }
+
+        if (depth == search_depth) // Если достигнута максимальная глубина
         {
-            return calc_score(mtx, (depth % 2 == color)); // Возврат оценки
+            ++stats.leaf_evals;
+            return evaluate<Eval>(pos, (depth % 2 == color)); // Возврат оценки
+        }
+
+        // Проверка таблицы транспозиций (только в начале хода, а не посреди серии взятий)
+        const int alpha_orig = alpha, beta_orig = beta;
+        const bool use_tt = (Prune::alpha_beta && sq == -1);
+        uint64_t key = 0;
+        bit_move tt_move;
+        if (use_tt)
+        {
+            key = tt_key(pos, color, depth);
+            tt_entry entry;
+            if (!tt->probe(key, entry))
+                ++tt_misses;
+            else
+            {
+                ++tt_hits;
+                if (entry.depth >= int(search_depth - depth) &&
+                    (entry.bound == Bound::EXACT ||
+                     (entry.bound == Bound::LOWER && entry.score >= beta) ||
+                     (entry.bound == Bound::UPPER && entry.score <= alpha)))
+                    return entry.score;
+                tt_move = entry.move; // Лучший ход прошлого поиска просчитывается первым
+            }
         }
 
         // Поиск ходов для текущего состояния
-        if (x != -1) {
-            find_turns(x, y, mtx);
+        MoveList turns_now; // Текущие ходы (на стеке)
+        bool have_beats_now; // Есть ли взятия
+        if (sq != -1) {
+            have_beats_now = gen_piece_turns(pos, sq, turns_now);
         }
         else {
-            find_turns(color, mtx);
+            have_beats_now = gen_turns(pos, color, turns_now);
         }
-        auto turns_now = turns; // Текущие ходы
-        bool have_beats_now = have_beats; // Есть ли взятия
+        if (Prune::alpha_beta)
+            order_turns(pos, color, depth, tt_move, turns_now);
 
         // Если нет взятий и это не начальное состояние, переходим к следующему уровню
-        if (!have_beats_now && x != -1) {
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
+        if (!have_beats_now && sq != -1) {
+            ++pv_ply;
+            const int score = find_best_turns_rec<Eval, Prune>(pos, 1 - color, depth + 1, alpha, beta);
+            --pv_ply;
+            pv_table[ply] = pv_table[ply + 1];
+            return score;
         }
 
         // Если ходов нет
-        if (turns.empty()) {
-            return (depth % 2 ? 0 : INF); // Возврат INF или 0
+        if (turns_now.empty()) {
+            return (depth % 2 ? -WIN_SCORE : WIN_SCORE); // Проигрыш того, кто ходит
         }
 
-        double min_score = INF + 1; // Минимальный счет
-        double max_score = -1; // Максимальный счет
+        const bool is_max = depth % 2; // Узел максимума (ходит бот)
+        int min_score = INF; // Минимальный счет
+        int max_score = -INF; // Максимальный счет
+        bit_move best_turn; // Лучший ход для таблицы транспозиций
 
         // Перебор всех возможных ходов
+        bool first_turn = true;
         for (auto turn : turns_now) {
-            double score = 0.0;
+            int score = 0;
 
-            // Если нет взятий и это начальное состояние
-            if (!have_beats_now && x == -1) {
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
-            }
-            else {
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
+            // Ход без взятия передает ход сопернику, взятие продолжает серию в этом же узле
+            const undo_info undo = make_turn(pos, turn);
+            eval_make<Eval>(pos, turn, undo);
+            const bool ends_turn = !have_beats_now && sq == -1;
+            const int chain = capture_chain;
+            if (!ends_turn)
+                count_capture(sq == -1);
+            auto search_child = [&](const int a, const int b) {
+                ++pv_ply;
+                const int child = ends_turn ? find_best_turns_rec<Eval, Prune>(pos, 1 - color, depth + 1, a, b)
+                                            : find_best_turns_rec<Eval, Prune>(pos, color, depth, a, b, turn.to);
+                --pv_ply;
+                return child;
+            };
+            if (!Prune::alpha_beta || first_turn)
+                score = search_child(alpha, beta);
+            else
+            {
+                // Нулевое окно: ход только проверяется на улучшение границы; если улучшает - пересчет
+                score = is_max ? search_child(alpha, alpha + 1) : search_child(beta - 1, beta);
+                if (score > alpha && score < beta && !stop)
+                {
+                    ++stats.pvs_researches;
+                    score = search_child(alpha, beta);
+                }
             }
+            capture_chain = chain;
+            eval_unmake<Eval>();
+            unmake_turn(pos, turn, undo);
+            if (stop) // Бюджет исчерпан, результат узла не сохраняется
+                return 0;
 
             // Обновление минимального и максимального счета
+            if (is_max ? score > max_score : score < min_score)
+                best_turn = turn;
+            if (is_max ? score > alpha : score < beta) // Ход улучшил границу окна - он в главном варианте узла
+                pv_update(ply, turn);
             min_score = min(min_score, score);
             max_score = max(max_score, score);
 
             // Альфа-бета отсечение
-            if (depth % 2)
+            if (is_max)
                 alpha = max(alpha, max_score);
             else
                 beta = min(beta, min_score);
 
             // Если отсечение сработало
-            if (optimization != "O0" && alpha >= beta) {
-                return (depth % 2 ? max_score + 1 : min_score - 1);
+            if (Prune::alpha_beta && alpha >= beta) {
+                ++stats.cutoff_nodes;
+                stats.first_move_cutoffs += first_turn;
+                if (sq == -1 && turn.cap == -1) // Тихий ход, вызвавший отсечение, запоминается
+                {
+                    if (!(killers[depth][0] == turn))
+                    {
+                        killers[depth][1] = killers[depth][0];
+                        killers[depth][0] = turn;
+                    }
+                    history[color][turn.from][turn.to] += int((search_depth - depth) * (search_depth - depth));
+                }
+                break;
             }
+            first_turn = false;
+        }
+        const int res = (is_max ? max_score : min_score); // Оценка узла
+
+        // Сохранение в таблицу транспозиций: оценка вне окна (alpha, beta) - только граница
+        if (use_tt)
+        {
+            Bound bound = Bound::EXACT;
+            if (res <= alpha_orig)
+                bound = Bound::UPPER;
+            else if (res >= beta_orig)
+                bound = Bound::LOWER;
+            tt->store(key, int(search_depth - depth), bound, res, best_turn);
         }
-        return (depth % 2 ? max_score : min_score); // Возврат счета
+        return res; // Возврат счета
     }
 
-public:
-    // Поиск ходов для цвета
-    void find_turns(const bool color)
+    // Главный вариант собирается при поиске в треугольной таблице: строка ply - лучшая линия из узла
+    // на этом уровне рекурсии (шаги ходов). Вход в узел очищает его строку
+    size_t pv_enter()
     {
-        find_turns(color, board->get_board());
+        const size_t ply = pv_ply;
+        if (pv_table.size() < ply + 2)
+            pv_table.resize(ply + 2);
+        pv_table[ply].clear();
+        return ply;
     }
 
-    // Поиск ходов для позиции
-    void find_turns(const POS_T x, const POS_T y)
+    // Шаг turn улучшил узел: его линия - этот шаг и линия дочернего узла
+    void pv_update(const size_t ply, const bit_move turn)
     {
-        find_turns(x, y, board->get_board());
+        vector<bit_move>& line = pv_table[ply];
+        const vector<bit_move>& child = pv_table[ply + 1];
+        line.clear();
+        line.push_back(turn);
+        line.insert(line.end(), child.begin(), child.end());
     }
 
-private:
-    // Поиск ходов для цвета на доске
-    void find_turns(const bool color, const vector<vector<POS_T>>& mtx)
+    // Оценка листа: нейросетевая - по аккумулятору текущего шага, остальные - по счетчикам позиции
+    template <class Eval> int evaluate(const Position& pos, const bool first_bot_color) const
     {
-        vector<move_pos> res_turns;
-        bool have_beats_before = false;
-        for (POS_T i = 0; i < 8; ++i)
-        {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                if (mtx[i][j] && mtx[i][j] % 2 != color) // Если фигура противника
-                {
-                    find_turns(i, j, mtx); // Поиск ходов
-                    if (have_beats && !have_beats_before) // Если есть взятия
-                    {
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before)
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end()); // Добавление ходов
-                    }
-                }
-            }
-        }
-        turns = res_turns; // Обновление ходов
-        shuffle(turns.begin(), turns.end(), rand_eng); // Перемешивание ходов
-        have_beats = have_beats_before; // Обновление флага взятий
+        if constexpr (Eval::uses_accumulator)
+            return nnue->score(nnue_stack.back(), pos, first_bot_color);
+        else
+            return Eval::score(pos, first_bot_color, weights);
     }
 
-    // Поиск ходов для позиции на доске
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx)
+    // Шаг хода в состоянии оценки (аккумулятор нужен только нейросетевой оценке); pos - после make_turn
+    template <class Eval> void eval_make(const Position& pos, const bit_move turn, const undo_info undo)
     {
-        turns.clear();
-        have_beats = false;
-        POS_T type = mtx[x][y]; // Тип фигуры
-        // Проверка взятий
-        switch (type)
+        if constexpr (Eval::uses_accumulator)
         {
-        case 1:
-        case 2:
-            // Для обычных фигур
-            for (POS_T i = x - 2; i <= x + 2; i += 4)
-            {
-                for (POS_T j = y - 2; j <= y + 2; j += 4)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7)
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2;
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb); // Добавление хода с взятием
-                }
-            }
-            break;
-        default:
-            // Для дамок
-            for (POS_T i = -1; i <= 1; i += 2)
-            {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    POS_T xb = -1, yb = -1;
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                        {
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
-                            {
-                                break;
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2)
-                        {
-                            turns.emplace_back(x, y, i2, j2, xb, yb); // Добавление хода с взятием
-                        }
-                    }
-                }
-            }
-            break;
+            nnue_stack.emplace_back();
+            nnue->update(nnue_stack[nnue_stack.size() - 2], pos, turn, undo, nnue_stack.back());
         }
-        // Проверка обычных ходов
-        if (!turns.empty())
-        {
-            have_beats = true; // Установка флага взятий
+    }
+
+    template <class Eval> void eval_unmake()
+    {
+        if constexpr (Eval::uses_accumulator)
+            nnue_stack.pop_back();
+    }
+
+    // Оценка результата эндшпильной таблицы для бота: выигрыш тем выше, чем он ближе,
+    // проигрыш - тем выше, чем он дальше; ничья равна равному материалу
+    static int tb_score(const tb_result& tb, const bool bot_turn)
+    {
+        if (!tb.value)
+            return 0;
+        if ((tb.value > 0) == bot_turn)
+            return WIN_SCORE - tb.dist;
+        return -WIN_SCORE + tb.dist; // Меньше любой оценки по материалу
+    }
+
+    // Сортировка ходов: ход из таблицы (или лучший ход прошлой глубины), взятия (дамок - раньше),
+    // превращения в дамку, ходы-убийцы этой глубины, затем тихие ходы по истории отсечений.
+    // Устойчивая сортировка вставками на месте: ходов мало, память не выделяется.
+    void order_turns(const Position& pos, const bool color, const size_t depth, const bit_move first, MoveList& turns_now) const
+    {
+        if (turns_now.size() < 2)
             return;
-        }
-        switch (type)
-        {
-        case 1:
-        case 2:
-            // Для обычных фигур
+        const BB promotion_row = color ? ROW_7 : ROW_0;
+        int scores[MAX_TURNS];
+        for (int i = 0; i < turns_now.size(); ++i)
         {
-            POS_T i = ((type % 2) ? x - 1 : x + 1);
-            for (POS_T j = y - 1; j <= y + 1; j += 2)
+            const bit_move turn = turns_now[i];
+            int score = history[color][turn.from][turn.to];
+            if (turn == first)
+                score = 1 << 30;
+            else if (turn.cap != -1)
+                score = (1 << 28) + ((pos.kings >> turn.cap) & 1) * (1 << 20);
+            else if (!((pos.kings >> turn.from) & 1) && ((promotion_row >> turn.to) & 1))
+                score = 1 << 27;
+            else if (depth < killers.size() && killers[depth][0] == turn)
+                score = 1 << 26;
+            else if (depth < killers.size() && killers[depth][1] == turn)
+                score = (1 << 26) - 1;
+
+            // Вставка на место среди уже отсортированных
+            int j = i;
+            for (; j > 0 && scores[j - 1] < score; --j)
             {
-                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
-                    continue;
-                turns.emplace_back(x, y, i, j); // Добавление хода
+                scores[j] = scores[j - 1];
+                turns_now[j] = turns_now[j - 1];
             }
-            break;
+            scores[j] = score;
+            turns_now[j] = turn;
         }
-        default:
-            // Для дамок
-            for (POS_T i = -1; i <= 1; i += 2)
+    }
+
+    // Шаг взятия в статистике: серия начинается заново в начале хода
+    void count_capture(const bool series_start)
+    {
+        capture_chain = series_start ? 1 : capture_chain + 1;
+        stats.max_capture_chain = max(stats.max_capture_chain, capture_chain);
+    }
+
+    // Время с начала поиска в миллисекундах
+    long long elapsed_ms() const
+    {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_time).count();
+    }
+
+    // То же с долями миллисекунды (для статистики)
+    double elapsed_ms_precise() const
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+    }
+
+    // Бюджет узлов текущего поиска: у размышления он задается после хода соперника
+    size_t current_node_budget() const
+    {
+        return ponder_node_budget ? ponder_node_budget->load(memory_order_relaxed) : node_budget;
+    }
+
+    // Остановка поиска при исчерпании бюджета времени или узлов
+    void check_budget()
+    {
+        if (abort_search->load(memory_order_relaxed))
+            stop = true;
+        const size_t budget_nodes = current_node_budget();
+        if ((move_budget_ms && elapsed_ms() >= move_budget_ms) || (budget_nodes && nodes >= budget_nodes))
+            stop = true;
+    }
+
+public:
+    // Поиск ходов для цвета на доске; если есть взятия, в списке только они
+    vector<move_pos> find_turns(const bool color, const vector<vector<POS_T>>& mtx) const
+    {
+        MoveList bit_turns;
+        gen_turns(Position::from_mtx(mtx), color, bit_turns);
+        return to_move_pos(bit_turns);
+    }
+
+    // Поиск ходов фигуры на клетке (x, y) доски; если есть взятия, в списке только они
+    vector<move_pos> find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx) const
+    {
+        MoveList bit_turns;
+        gen_piece_turns(Position::from_mtx(mtx), sq_index(x, y), bit_turns);
+        return to_move_pos(bit_turns);
+    }
+
+    // Запись последнего поиска хода turns цвета color из позиции pos для файла статистики (строка JSON).
+    // Главный вариант собран поиском последней досчитанной глубины; у хода из книги он - сам ход
+    json search_report(const bool color, const Position& pos, const vector<move_pos>& turns) const
+    {
+        vector<bit_move> steps;
+        for (const auto& turn : turns)
+            steps.emplace_back(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2),
+                               turn.xb == -1 ? -1 : sq_index(turn.xb, turn.yb));
+        json pv = json::array();
+        if (book_move || pv_line.empty())
+            pv.push_back(move_name(steps));
+        else
+        {
+            // Шаги делятся на ходы: шаг после взятия с той же клетки продолжает серию
+            steps.clear();
+            for (const auto& step : pv_line)
             {
-                for (POS_T j = -1; j <= 1; j += 2)
+                if (!steps.empty() && (steps.back().cap == -1 || step.from != steps.back().to))
                 {
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                            break;
-                        turns.emplace_back(x, y, i2, j2); // Добавление хода
-                    }
+                    pv.push_back(move_name(steps));
+                    steps.clear();
                 }
+                steps.push_back(step);
             }
-            break;
+            pv.push_back(move_name(steps));
         }
+        return { { "color", color ? "black" : "white" },
+                 { "position", pos.to_string() },
+                 { "level", Max_depth },
+                 { "depth", book_move ? 0 : completed_depth },
+                 { "book_move", book_move },
+                 { "ponder_hit", ponder_hit },
+                 { "time_ms", stats.time_ms },
+                 { "nodes", nodes },
+                 { "nps", stats.time_ms > 0 ? size_t(nodes * 1000 / stats.time_ms) : 0 },
+                 { "leaf_evals", stats.leaf_evals },
+                 { "cutoff_nodes", stats.cutoff_nodes },
+                 { "first_move_cutoff_rate", stats.first_move_cutoff_rate() },
+                 { "pvs_researches", stats.pvs_researches },
+                 { "aspiration_researches", stats.aspiration_researches },
+                 { "ebf", stats.ebf() },
+                 { "depth_nodes", stats.depth_nodes },
+                 { "depth_ms", stats.depth_ms },
+                 { "max_capture_chain", stats.max_capture_chain },
+                 { "tt_hits", tt_hits },
+                 { "tt_misses", tt_misses },
+                 { "tb_hits", tb_hits },
+                 { "pv", pv } };
+    }
+
+private:
+    static vector<move_pos> to_move_pos(const MoveList& bit_turns)
+    {
+        vector<move_pos> res;
+        for (auto turn : bit_turns)
+            res.push_back(turn.to_move_pos());
+        return res;
     }
 
 public:
-    vector<move_pos> turns; // Список ходов
-    bool have_beats; // Флаг наличия взятий
     int Max_depth; // Максимальная глубина поиска
+    int completed_depth = -1; // Последняя полностью просчитанная глубина
+    size_t nodes = 0; // Число узлов, просмотренных за последний поиск (всеми потоками)
+    size_t tt_hits = 0; // Число найденных в таблице транспозиций позиций за последний поиск
+    size_t tt_misses = 0; // Число промахов таблицы транспозиций за последний поиск
+    size_t tb_hits = 0; // Число позиций, найденных в эндшпильных таблицах за последний поиск
+    bool book_move = false; // Последний ход взят из дебютной книги
+    bool ponder_hit = false; // Последний ход найден поиском, начатым на времени соперника
+    search_stats stats; // Подробная статистика последнего поиска
+    string weights_error; // Ошибка файла весов оценок: веса по умолчанию (пустая строка - ошибок не было)
+    string nnue_error; // Сеть для режима Nnue не загружена: оценка NumberAndPotential (пустая строка - ошибок не было)
 
 private:
     default_random_engine rand_eng; // Генератор случайных чисел
-    string scoring_mode; // Режим подсчета очков
-    string optimization; // Режим оптимизации
-    vector<move_pos> next_move; // Следующий ход
+    ScoringType scoring_mode = ScoringType::NumberAndPotential; // Режим подсчета очков
+    search_fn search = nullptr; // Поиск, специализированный под режимы подсчета и оптимизации
+    bool aspiration = true; // Корень ищется в окне вокруг оценки прошлой глубины
+    bool no_random = false; // Детерминированный бот (без случайного выбора равных ходов)
+    size_t tt_size_mb = 0; // Размер таблицы транспозиций из настроек
+    string tablebase_path; // Загруженный файл эндшпильных таблиц
+    string book_path; // Загруженный файл дебютной книги
+    string nnue_path; // Загруженный файл нейросетевой оценки
+    string nnue_load_error; // Ошибка загрузки файла сети
+    string weights_path; // Загруженный файл весов оценок
+    eval_weights weights; // Веса оценок по фигурам
+    long long time_budget_ms = 0; // Бюджет времени на ход (0 - без ограничения)
+    long long move_budget_ms = 0; // Бюджет времени текущего поиска с учетом накопленного
+    long long time_bank_ms[2] = {}; // Время, сэкономленное ходами из книги, по цветам
+    size_t node_budget = 0; // Бюджет узлов на ход (0 - без ограничения)
+    shared_ptr<atomic<size_t>> ponder_node_budget; // Бюджет узлов размышления, задается после хода соперника (nullptr - не размышление)
+    int threads = 1; // Число потоков поиска
+    shared_ptr<TranspositionTable> tt; // Таблица транспозиций
+    shared_ptr<const Tablebase> tablebase; // Эндшпильные таблицы (nullptr - не загружены)
+    shared_ptr<const OpeningBook> book; // Дебютная книга (nullptr - не загружена)
+    shared_ptr<const Nnue> nnue; // Нейросетевая оценка (nullptr - не загружена)
+    vector<nnue_accumulator> nnue_stack; // Аккумуляторы по шагам текущей ветки поиска
+    shared_ptr<ponder_search> ponder; // Текущее размышление на времени соперника
+    shared_ptr<atomic<bool>> abort_search; // Сигнал помощникам о завершении поиска главным потоком
+    size_t search_depth = 0; // Глубина текущей итерации
+    int capture_chain = 0; // Длина текущей серии взятий (для статистики)
+    bool stop = false; // Флаг остановки поиска
+    chrono::steady_clock::time_point start_time; // Время начала поиска
+    bit_move pv_move; // Лучший ход последней досчитанной глубины
+    vector<vector<bit_move>> pv_table; // Треугольная таблица главного варианта по уровням рекурсии
+    size_t pv_ply = 0; // Уровень рекурсии текущего узла
+    vector<bit_move> pv_line; // Главный вариант последней досчитанной глубины (шаги ходов)
+    vector<array<bit_move, 2>> killers; // Ходы-убийцы для каждой глубины
+    int history[2][32][32] = {}; // История отсечений тихих ходов: цвет, откуда, куда
+    vector<bit_move> next_move; // Следующий ход
     vector<int> next_best_state; // Следующее состояние
-    Board* board; // Указатель на доску
     Config* config; // Указатель на конфиг
 };
\ No newline at end of file
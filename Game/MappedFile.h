@@ -0,0 +1,114 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Файл, отображенный в память только для чтения: файл не читается целиком, страницы подгружаются при обращении
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // Отображение файла; false, если файла нет, он пуст или отображение не удалось
+    bool open(const string& path)
+    {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || !file_size.QuadPart)
+            return close_fail();
+        length = uint64_t(file_size.QuadPart);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+            return close_fail();
+        ptr = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        return ptr || close_fail();
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) || !st.st_size)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* res = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // Отображение остается действительным после закрытия файла
+        if (res == MAP_FAILED)
+            return false;
+        ptr = static_cast<const uint8_t*>(res);
+        length = uint64_t(st.st_size);
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (ptr)
+            UnmapViewOfFile(ptr);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr)
+            munmap(const_cast<uint8_t*>(ptr), size_t(length));
+#endif
+        ptr = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const
+    {
+        return ptr;
+    }
+
+    uint64_t size() const
+    {
+        return length;
+    }
+
+private:
+    bool close_fail()
+    {
+        close();
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    const uint8_t* ptr = nullptr; // Начало отображенного файла
+    uint64_t length = 0; // Размер файла
+};
@@ -0,0 +1,254 @@
+﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "Bitboard.h"
+#include "Eval.h"
+#include "EvalKernel.h"
+
+// Нейросетевая оценка позиции (NNUE): небольшая целочисленная сеть 128 -> 64 -> 32 -> 1.
+// Входы - 128 признаков: тип фигуры (код Position::piece от 1 до 4) и клетка. Первый слой - сумма
+// столбцов весов по фигурам на доске (аккумулятор int16), ее поиск обновляет на каждом шаге хода:
+// убирается фигура с клетки откуда и битая фигура, добавляется фигура на клетке куда.
+// Дальше ограниченный ReLU до 127 (uint8), слой int8 -> int32, ограниченный ReLU и выход int32.
+// Выход сети - логарифм отношения материала черных к материалу белых в единицах 1 / (NNUE_QA * NNUE_QB),
+// поэтому выход, переведенный в единицы SCORE_SCALE, сравним с остальными оценками.
+// Сети строит утилита Tools/nnuetrain.cpp.
+//
+// Формат файла: заголовок nnue_header, затем веса по порядку полей nnue_weights без выравнивания.
+
+constexpr int NNUE_INPUTS = 128;
+constexpr int NNUE_L1 = 64;
+constexpr int NNUE_L2 = 32;
+constexpr int NNUE_QA = 127; // Единица активаций первого и второго слоя
+constexpr int NNUE_QB = 64; // Единица весов int8
+constexpr int NNUE_MAX_FEATURES = 24; // Наибольшее число признаков позиции (фигур на доске)
+constexpr uint32_t NNUE_VERSION = 1;
+
+// Номер признака фигуры piece (1 - белая, 2 - черная, 3 - белая дамка, 4 - черная дамка) на клетке sq
+inline int nnue_feature(const int piece, const int sq)
+{
+    return (piece - 1) * 32 + sq;
+}
+
+// Заголовок файла сети
+struct nnue_header
+{
+    char magic[4]; // "CKNN"
+    uint32_t version; // NNUE_VERSION
+    uint32_t inputs, l1, l2; // Размеры слоев
+};
+
+// Веса сети
+struct nnue_weights
+{
+    alignas(32) int16_t l1_bias[NNUE_L1];
+    alignas(32) int16_t l1_weights[NNUE_INPUTS][NNUE_L1]; // Столбец весов на признак
+    alignas(32) int32_t l2_bias[NNUE_L2];
+    alignas(32) int8_t l2_weights[NNUE_L2][NNUE_L1]; // Строка весов на выход
+    alignas(32) int8_t l3_weights[NNUE_L2];
+    int32_t l3_bias;
+};
+
+// Аккумулятор первого слоя для одной позиции
+struct nnue_accumulator
+{
+    alignas(32) int16_t v[NNUE_L1];
+};
+
+class Nnue
+{
+public:
+    // Загрузка сети; false, если файла нет или он поврежден (описание ошибки - в error)
+    bool load(const string& path, string& error)
+    {
+        ifstream fin(path, ios::binary);
+        if (!fin)
+        {
+            error = path + ": cannot open";
+            return false;
+        }
+        nnue_header header;
+        if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, "CKNN", 4) ||
+            header.version != NNUE_VERSION || header.inputs != NNUE_INPUTS || header.l1 != NNUE_L1 ||
+            header.l2 != NNUE_L2)
+        {
+            error = path + ": not a network file of this version";
+            return false;
+        }
+        if (!for_each_field([&fin](char* data, const size_t size) { return bool(fin.read(data, streamsize(size))); }) ||
+            fin.peek() != char_traits<char>::eof())
+        {
+            error = path + ": wrong file size";
+            return false;
+        }
+        error.clear();
+        return true;
+    }
+
+    // Запись сети (для утилиты обучения)
+    bool save(const string& path)
+    {
+        ofstream fout(path, ios::binary);
+        const nnue_header header{ { 'C', 'K', 'N', 'N' }, NNUE_VERSION, NNUE_INPUTS, NNUE_L1, NNUE_L2 };
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return for_each_field([&fout](char* data, const size_t size) { return bool(fout.write(data, streamsize(size))); });
+    }
+
+    // Аккумулятор позиции с нуля
+    void refresh(const Position& pos, nnue_accumulator& acc) const
+    {
+        copy(begin(w.l1_bias), end(w.l1_bias), acc.v);
+        for (BB b = pos.occupied(); b; b &= b - 1)
+        {
+            const int sq = lsb(b);
+            add_column(acc, nnue_feature(pos.piece(sq), sq));
+        }
+    }
+
+    // Аккумулятор после шага хода turn по аккумулятору до шага; pos - позиция после make_turn
+    void update(const nnue_accumulator& prev, const Position& pos, const bit_move turn, const undo_info undo,
+                nnue_accumulator& acc) const
+    {
+        const int piece = pos.piece(turn.to);
+        const int16_t* sub1 = w.l1_weights[nnue_feature(undo.promoted ? piece - 2 : piece, turn.from)];
+        const int16_t* add = w.l1_weights[nnue_feature(piece, turn.to)];
+        const int16_t* sub2 = undo.captured ? w.l1_weights[nnue_feature(undo.captured, turn.cap)] : nullptr;
+#ifdef EVAL_HAS_AVX2_PATH
+        if (avx2)
+        {
+            update_avx2(prev, add, sub1, sub2, acc);
+            return;
+        }
+#endif
+        for (int i = 0; i < NNUE_L1; ++i)
+            acc.v[i] = int16_t(prev.v[i] + add[i] - sub1[i] - (sub2 ? sub2[i] : 0));
+    }
+
+    // Выход сети по аккумулятору (скалярный путь и AVX2 дают одинаковый результат)
+    int32_t forward(const nnue_accumulator& acc) const
+    {
+#ifdef EVAL_HAS_AVX2_PATH
+        if (avx2)
+            return forward_avx2(acc);
+#endif
+        return forward_scalar(acc);
+    }
+
+    int32_t forward_scalar(const nnue_accumulator& acc) const
+    {
+        uint8_t h1[NNUE_L1];
+        for (int i = 0; i < NNUE_L1; ++i)
+            h1[i] = uint8_t(clamp<int>(acc.v[i], 0, NNUE_QA));
+        int32_t out = w.l3_bias;
+        for (int j = 0; j < NNUE_L2; ++j)
+        {
+            int32_t sum = w.l2_bias[j];
+            for (int i = 0; i < NNUE_L1; ++i)
+                sum += h1[i] * w.l2_weights[j][i];
+            out += clamp<int32_t>(sum >> 6, 0, NNUE_QA) * w.l3_weights[j];
+        }
+        return out;
+    }
+
+    // Оценка в единицах остальных оценок (SCORE_SCALE на единицу логарифма отношения материала)
+    // за сторону first_bot_color; WIN_SCORE и -WIN_SCORE, если у одной из сторон нет фигур
+    int score(const nnue_accumulator& acc, const Position& pos, const bool first_bot_color) const
+    {
+        if (!(pos.men_count[!first_bot_color] + pos.kings_count[!first_bot_color]))
+            return WIN_SCORE;
+        if (!(pos.men_count[first_bot_color] + pos.kings_count[first_bot_color]))
+            return -WIN_SCORE;
+        const int res = clamp(int(int64_t(forward(acc)) * SCORE_SCALE / (NNUE_QA * NNUE_QB)), -20 * SCORE_SCALE,
+                              20 * SCORE_SCALE);
+        return first_bot_color ? res : -res;
+    }
+
+    nnue_weights w{}; // Веса сети
+
+private:
+    // Перебор полей весов в порядке файла
+    template <class F> bool for_each_field(F&& f)
+    {
+        return f(reinterpret_cast<char*>(w.l1_bias), sizeof(w.l1_bias)) &&
+               f(reinterpret_cast<char*>(w.l1_weights), sizeof(w.l1_weights)) &&
+               f(reinterpret_cast<char*>(w.l2_bias), sizeof(w.l2_bias)) &&
+               f(reinterpret_cast<char*>(w.l2_weights), sizeof(w.l2_weights)) &&
+               f(reinterpret_cast<char*>(w.l3_weights), sizeof(w.l3_weights)) &&
+               f(reinterpret_cast<char*>(&w.l3_bias), sizeof(w.l3_bias));
+    }
+
+    void add_column(nnue_accumulator& acc, const int feature) const
+    {
+        for (int i = 0; i < NNUE_L1; ++i)
+            acc.v[i] = int16_t(acc.v[i] + w.l1_weights[feature][i]);
+    }
+
+#ifdef EVAL_HAS_AVX2_PATH
+    EVAL_TARGET_AVX2 static void update_avx2(const nnue_accumulator& prev, const int16_t* add, const int16_t* sub1,
+                                             const int16_t* sub2, nnue_accumulator& acc)
+    {
+        for (int i = 0; i < NNUE_L1; i += 16)
+        {
+            __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(prev.v + i));
+            v = _mm256_add_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(add + i)));
+            v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(sub1 + i)));
+            if (sub2)
+                v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(sub2 + i)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(acc.v + i), v);
+        }
+    }
+
+public:
+    // Путь AVX2 (открыт для сравнения со скалярным в тестах): активации первого слоя упаковываются
+    // в uint8, второй слой считается vpmaddubsw по 4 выхода за раз с горизонтальным сложением
+    EVAL_TARGET_AVX2 int32_t forward_avx2(const nnue_accumulator& acc) const
+    {
+        const __m256i zero = _mm256_setzero_si256(), qa16 = _mm256_set1_epi16(NNUE_QA), ones16 = _mm256_set1_epi16(1);
+        __m256i h1[NNUE_L1 / 32];
+        for (int k = 0; k < NNUE_L1 / 32; ++k)
+        {
+            const __m256i a = _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(acc.v + 32 * k)), qa16);
+            const __m256i b =
+                _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(acc.v + 32 * k + 16)), qa16);
+            h1[k] = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8); // packus чередует половины регистров
+        }
+        alignas(32) int32_t h2[NNUE_L2];
+        for (int j = 0; j < NNUE_L2; j += 4)
+        {
+            __m256i sums[4];
+            for (int r = 0; r < 4; ++r)
+            {
+                sums[r] = zero;
+                for (int k = 0; k < NNUE_L1 / 32; ++k)
+                {
+                    const __m256i weights = _mm256_load_si256(reinterpret_cast<const __m256i*>(w.l2_weights[j + r] + 32 * k));
+                    sums[r] = _mm256_add_epi32(sums[r], _mm256_madd_epi16(_mm256_maddubs_epi16(h1[k], weights), ones16));
+                }
+            }
+            const __m256i s = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[0], sums[1]), _mm256_hadd_epi32(sums[2], sums[3]));
+            __m128i res = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+            res = _mm_add_epi32(res, _mm_load_si128(reinterpret_cast<const __m128i*>(w.l2_bias + j)));
+            res = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(res, 6), _mm_setzero_si128()), _mm_set1_epi32(NNUE_QA));
+            _mm_store_si128(reinterpret_cast<__m128i*>(h2 + j), res);
+        }
+        int32_t out = w.l3_bias;
+        for (int j = 0; j < NNUE_L2; ++j)
+            out += h2[j] * w.l3_weights[j];
+        return out;
+    }
+
+private:
+    bool avx2 = cpu_has_avx2(); // Путь выбирается один раз при создании
+#endif
+};
+
+// Политика оценки для поиска: оценка по аккумулятору, который поиск обновляет на каждом шаге
+struct NnueEval
+{
+    static constexpr bool uses_accumulator = true;
+};
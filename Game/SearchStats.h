@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// Статистика одного поиска хода (Logic::stats). Счетчики узлов, листьев и отсечений собираются всеми
+// потоками, времена и узлы по глубинам - главным потоком. Запись хода в формате JSON строит
+// Logic::search_report; игра дописывает ее строкой в файл настройки "SearchStats".
+struct search_stats
+{
+    size_t leaf_evals = 0; // Оценки листьев
+    size_t cutoff_nodes = 0; // Узлы с отсечением
+    size_t first_move_cutoffs = 0; // Из них отсечение первым же ходом
+    size_t pvs_researches = 0; // Пересчеты с полным окном после нулевого окна (PVS)
+    size_t aspiration_researches = 0; // Пересчеты глубины после выхода оценки из окна аспирации
+    int max_capture_chain = 0; // Самая длинная просмотренная серия взятий
+    double time_ms = 0; // Время поиска
+    vector<size_t> depth_nodes; // Узлы каждой досчитанной глубины итеративного углубления
+    vector<double> depth_ms; // Время каждой досчитанной глубины
+
+    // Добавление счетчиков помощника Lazy SMP
+    void add(const search_stats& other)
+    {
+        leaf_evals += other.leaf_evals;
+        cutoff_nodes += other.cutoff_nodes;
+        first_move_cutoffs += other.first_move_cutoffs;
+        pvs_researches += other.pvs_researches;
+        aspiration_researches += other.aspiration_researches;
+        max_capture_chain = max(max_capture_chain, other.max_capture_chain);
+    }
+
+    // Эффективный коэффициент ветвления: во сколько раз последняя глубина дороже предыдущей
+    double ebf() const
+    {
+        const size_t n = depth_nodes.size();
+        return n >= 2 && depth_nodes[n - 2] ? double(depth_nodes[n - 1]) / depth_nodes[n - 2] : 0;
+    }
+
+    // Доля отсечений первым ходом: чем ближе к 1, тем лучше сортировка ходов
+    double first_move_cutoff_rate() const
+    {
+        return cutoff_nodes ? double(first_move_cutoffs) / cutoff_nodes : 0;
+    }
+};
@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "Bitboard.h"
+#include "Eval.h"
+
+// Тип оценки, сохраненной в таблице
+enum class Bound : uint8_t
+{
+    EXACT, // Точная оценка
+    LOWER, // Оценка не меньше сохраненной (было отсечение в узле максимума)
+    UPPER  // Оценка не больше сохраненной
+};
+
+// Запись таблицы транспозиций
+struct tt_entry
+{
+    uint64_t key = 0; // Полный хеш позиции
+    int score = 0; // Оценка
+    int8_t depth = -1; // Оставшаяся глубина поиска, для которой получена оценка
+    Bound bound = Bound::EXACT; // Тип оценки
+    bit_move move; // Лучший ход (первый шаг серии взятий)
+};
+
+// Таблица транспозиций фиксированного размера, общая для всех потоков поиска.
+// Работает без блокировок: в ячейке хранится хеш, сложенный по XOR с данными, поэтому запись,
+// разорванная одновременной записью другого потока, не проходит проверку и считается промахом.
+class TranspositionTable
+{
+public:
+    static constexpr int MAX_DEPTH = 126; // Наибольшая сохраняемая глубина: в записи она хранится как int8_t
+
+    // Выделение таблицы размером не больше size_mb мегабайт (число записей - степень двойки)
+    void resize(const size_t size_mb)
+    {
+        table.reset();
+        count = 0;
+        if (size_mb == 0) // Таблица отключена
+            return;
+        count = 1;
+        while (count * 2 * sizeof(slot) <= size_mb * 1024 * 1024)
+            count *= 2;
+        table.reset(new slot[count]());
+    }
+
+    // Очистка таблицы
+    void clear()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            table[i].check.store(0, memory_order_relaxed);
+            table[i].info.store(0, memory_order_relaxed);
+        }
+    }
+
+    // Поиск записи по хешу
+    bool probe(const uint64_t key, tt_entry& entry) const
+    {
+        if (!count)
+            return false;
+        const slot& cur = table[key & (count - 1)];
+        const uint64_t info = cur.info.load(memory_order_relaxed);
+        const uint64_t check = cur.check.load(memory_order_relaxed);
+        if (!info || (check ^ info) != key)
+            return false;
+        entry.key = key;
+        entry.score = int32_t(uint32_t(info >> 40) << 8) >> 8; // 24 бита со знаком
+        entry.depth = int8_t(int(info & 0xFF) - 1);
+        entry.bound = Bound((info >> 8) & 0xFF);
+        entry.move = bit_move(int8_t(info >> 16), int8_t(info >> 24), int8_t(info >> 32));
+        return true;
+    }
+
+    // Сохранение результата; более глубокий результат той же позиции не затирается.
+    // Глубина больше MAX_DEPTH сохраняется как MAX_DEPTH: запись остается пригодной для меньших глубин
+    void store(const uint64_t key, int depth, const Bound bound, const int score, const bit_move move)
+    {
+        if (!count)
+            return;
+        depth = min(depth, MAX_DEPTH);
+        slot& cur = table[key & (count - 1)];
+        const uint64_t old_info = cur.info.load(memory_order_relaxed);
+        if (old_info && int(old_info & 0xFF) - 1 > depth && (cur.check.load(memory_order_relaxed) ^ old_info) == key)
+            return;
+        const uint64_t info = uint64_t(depth + 1) | (uint64_t(bound) << 8) | (uint64_t(uint8_t(move.from)) << 16) |
+                              (uint64_t(uint8_t(move.to)) << 24) | (uint64_t(uint8_t(move.cap)) << 32) |
+                              (uint64_t(uint32_t(score) & 0xFFFFFF) << 40);
+        cur.check.store(key ^ info, memory_order_relaxed);
+        cur.info.store(info, memory_order_relaxed);
+    }
+
+private:
+    // Ячейка таблицы (16 байт): проверочное слово (хеш ^ данные) и упакованные данные
+    // (глубина + 1, тип оценки, ход, оценка - 24 бита со знаком); нулевые данные - пустая ячейка
+    struct slot
+    {
+        atomic<uint64_t> check;
+        atomic<uint64_t> info;
+    };
+    static_assert(WIN_SCORE < (1 << 23), "Score must fit in 24 bits");
+
+    unique_ptr<slot[]> table; // Ячейки таблицы
+    size_t count = 0; // Число ячеек
+};
@@ -0,0 +1,241 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "Bitboard.h"
+#include "MappedFile.h"
+
+// Эндшпильные таблицы: для каждой позиции с небольшим числом фигур хранится результат при лучшей игре
+// обеих сторон и число полуходов до конца партии. Таблицы строит утилита Tools/tbgen.cpp.
+//
+// Формат файла: заголовок tb_header, каталог из table_count записей tb_table_info, затем данные таблиц.
+// Хранятся только позиции, где ходят белые: позиция с ходом черных переворачивается (tb_flip).
+// Каждой позиции соответствует один байт: 0 - ничья (или невозможная позиция),
+// иначе число полуходов до конца партии + 1; нечетное число полуходов - выигрыш того, кто ходит.
+
+// Наибольшее число фигур в таблицах: tbgen держит в памяти все таблицы, для 6 фигур это около 5.5 ГБ
+// (для 7 - около 100 ГБ), а номер позиции каждой таблицы помещается в 32 бита
+constexpr int TB_MAX_PIECES = 6;
+constexpr uint32_t TB_VERSION = 1;
+
+// Материал позиции: число белых простых, белых дамок, черных простых, черных дамок
+struct tb_material
+{
+    int wm = 0, wk = 0, bm = 0, bk = 0;
+
+    static tb_material of(const Position& pos)
+    {
+        return { pop_count(pos.white & ~pos.kings), pop_count(pos.white & pos.kings),
+                 pop_count(pos.black & ~pos.kings), pop_count(pos.black & pos.kings) };
+    }
+
+    int total() const
+    {
+        return wm + wk + bm + bk;
+    }
+};
+
+// Биномиальные коэффициенты C(n, k) для n, k <= 32
+inline constexpr array<array<uint64_t, 33>, 33> make_binomials()
+{
+    array<array<uint64_t, 33>, 33> res{};
+    for (int n = 0; n <= 32; ++n)
+    {
+        res[n][0] = 1;
+        for (int k = 1; k <= n; ++k)
+            res[n][k] = res[n - 1][k - 1] + res[n - 1][k];
+    }
+    return res;
+}
+
+inline constexpr array<array<uint64_t, 33>, 33> BINOM = make_binomials();
+
+// Номер набора клеток среди всех наборов того же размера: сумма C(s_i, i) по клеткам s_1 < s_2 < ...
+inline uint64_t comb_index(BB b)
+{
+    uint64_t idx = 0;
+    for (int i = 1; b; b &= b - 1, ++i)
+        idx += BINOM[lsb(b)][i];
+    return idx;
+}
+
+// Набор из k клеток по его номеру (обратное к comb_index)
+inline BB comb_unrank(uint64_t idx, const int k)
+{
+    BB b = 0;
+    for (int i = k; i > 0; --i)
+    {
+        int s = i - 1;
+        while (BINOM[s + 1][i] <= idx)
+            ++s;
+        idx -= BINOM[s][i];
+        b |= BB(1) << s;
+    }
+    return b;
+}
+
+// Число позиций в таблице материала (с учетом невозможных, где группы фигур пересекаются)
+inline uint64_t tb_size(const tb_material& m)
+{
+    return BINOM[32][m.wm] * BINOM[32][m.wk] * BINOM[32][m.bm] * BINOM[32][m.bk];
+}
+
+// Номер позиции в таблице ее материала
+inline uint64_t tb_index(const Position& pos)
+{
+    const tb_material m = tb_material::of(pos);
+    uint64_t idx = comb_index(pos.white & ~pos.kings);
+    idx = idx * BINOM[32][m.wk] + comb_index(pos.white & pos.kings);
+    idx = idx * BINOM[32][m.bm] + comb_index(pos.black & ~pos.kings);
+    return idx * BINOM[32][m.bk] + comb_index(pos.black & pos.kings);
+}
+
+// Позиция по номеру в таблице; false, если позиция невозможна
+inline bool tb_position(const tb_material& m, uint64_t idx, Position& pos)
+{
+    const BB bk = comb_unrank(idx % BINOM[32][m.bk], m.bk);
+    idx /= BINOM[32][m.bk];
+    const BB bm = comb_unrank(idx % BINOM[32][m.bm], m.bm);
+    idx /= BINOM[32][m.bm];
+    const BB wk = comb_unrank(idx % BINOM[32][m.wk], m.wk);
+    const BB wm = comb_unrank(idx / BINOM[32][m.wk], m.wm);
+    if ((wm & wk) || ((wm | wk) & (bm | bk)) || (bm & bk))
+        return false;
+    if ((wm & ROW_0) || (bm & ROW_7)) // Простая на строке превращения уже была бы дамкой
+        return false;
+    pos.white = wm | wk;
+    pos.black = bm | bk;
+    pos.kings = wk | bk;
+    pos.refresh();
+    return true;
+}
+
+// Поворот доски на 180 градусов со сменой цвета фигур: клетка sq переходит в 31 - sq
+inline Position tb_flip(const Position& pos)
+{
+    auto reverse = [](BB b) {
+        b = ((b >> 1) & 0x55555555) | ((b & 0x55555555) << 1);
+        b = ((b >> 2) & 0x33333333) | ((b & 0x33333333) << 2);
+        b = ((b >> 4) & 0x0F0F0F0F) | ((b & 0x0F0F0F0F) << 4);
+        b = ((b >> 8) & 0x00FF00FF) | ((b & 0x00FF00FF) << 8);
+        return (b >> 16) | (b << 16);
+    };
+    Position res;
+    res.white = reverse(pos.black);
+    res.black = reverse(pos.white);
+    res.kings = reverse(pos.kings);
+    res.refresh();
+    return res;
+}
+
+// Заголовок файла таблиц
+struct tb_header
+{
+    char magic[4]; // "CKTB"
+    uint32_t version; // TB_VERSION
+    uint32_t max_pieces; // Наибольшее число фигур
+    uint32_t table_count; // Число таблиц
+};
+
+// Запись каталога: материал, смещение данных от начала файла и их размер
+struct tb_table_info
+{
+    uint8_t wm, wk, bm, bk;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Результат таблицы для того, кто ходит
+struct tb_result
+{
+    int value = 0; // 1 - выигрыш, 0 - ничья, -1 - проигрыш
+    int dist = 0; // Число полуходов до конца партии
+};
+
+// Таблицы, отображенные в память (MappedFile)
+class Tablebase
+{
+public:
+    // Открытие файла таблиц; false, если файла нет или он поврежден
+    bool load(const string& path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+        const uint8_t* data = file.data();
+        const uint64_t length = file.size();
+        tb_header header;
+        if (length < sizeof(header))
+            return close_fail();
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "CKTB", 4) || header.version != TB_VERSION || header.max_pieces > TB_MAX_PIECES ||
+            length < sizeof(header) + uint64_t(header.table_count) * sizeof(tb_table_info))
+            return close_fail();
+        for (uint32_t i = 0; i < header.table_count; ++i)
+        {
+            tb_table_info info;
+            memcpy(&info, data + sizeof(header) + i * sizeof(info), sizeof(info));
+            const tb_material m{ info.wm, info.wk, info.bm, info.bk };
+            if (m.total() > int(header.max_pieces) || info.size != tb_size(m) || info.offset > length ||
+                info.size > length - info.offset)
+                return close_fail();
+            tables[m.wm][m.wk][m.bm][m.bk] = data + info.offset;
+        }
+        max_pieces = int(header.max_pieces);
+        return true;
+    }
+
+    // Наибольшее число фигур в загруженных таблицах (0 - таблицы не загружены)
+    int pieces() const
+    {
+        return max_pieces;
+    }
+
+    // Результат позиции для цвета color, который ходит; false, если позиции нет в таблицах
+    bool probe(const Position& pos, const bool color, tb_result& res) const
+    {
+        if (pop_count(pos.occupied()) > max_pieces)
+            return false;
+        const Position cur = color ? tb_flip(pos) : pos;
+        if (!cur.white) // Фигур нет - проигрыш
+        {
+            res = { -1, 0 };
+            return true;
+        }
+        const tb_material m = tb_material::of(cur);
+        const uint8_t* table = tables[m.wm][m.wk][m.bm][m.bk];
+        if (!table)
+            return false;
+        const uint8_t value = table[tb_index(cur)];
+        if (!value)
+            res = { 0, 0 };
+        else
+            res = { (value - 1) % 2 ? 1 : -1, value - 1 };
+        return true;
+    }
+
+private:
+    void close()
+    {
+        file.close();
+        max_pieces = 0;
+        for (auto& a : tables)
+            for (auto& b : a)
+                for (auto& c : b)
+                    for (auto& table : c)
+                        table = nullptr;
+    }
+
+    bool close_fail()
+    {
+        close();
+        return false;
+    }
+
+    MappedFile file; // Файл таблиц
+    int max_pieces = 0; // Наибольшее число фигур
+    const uint8_t* tables[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1] = {}; // Таблицы по материалу
+};
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <fstream>
+#include <string>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+#include "Eval.h"
+
+// Файл весов оценок (строится утилитой Tools/texeltune.cpp), JSON вида
+// { "Potential": 0.05, "KingNumberOnly": 4, "King": 5 }; отсутствующий вес - значение по умолчанию.
+// Потенциал может быть равен 0 (оценка без продвижения), веса дамок - только больше 0.
+
+// Чтение весов; при ошибке веса не меняются. Нет файла - false без описания ошибки,
+// неверный файл (не JSON, вес не число или вне допустимых значений) - описание в error
+inline bool load_eval_weights(const string& path, eval_weights& weights, string& error)
+{
+    error.clear();
+    ifstream fin(path);
+    if (!fin)
+        return false;
+    const json file = json::parse(fin, nullptr, false);
+    if (!file.is_object())
+    {
+        error = path + ": expected a JSON object";
+        return false;
+    }
+    eval_weights res;
+    const struct
+    {
+        const char* key;
+        double* value;
+        bool allow_zero;
+    } fields[] = { { "Potential", &res.potential, true },
+                   { "KingNumberOnly", &res.king_number_only, false },
+                   { "King", &res.king, false } };
+    for (const auto& [key, value, allow_zero] : fields)
+    {
+        if (!file.contains(key))
+            continue;
+        const json& field = file[key];
+        if (!field.is_number() || field.get<double>() < 0 || (!allow_zero && field.get<double>() == 0))
+        {
+            error = path + ": " + key + ": expected a " + (allow_zero ? "non-negative" : "positive") +
+                    " number, got " + field.dump();
+            return false;
+        }
+        *value = field.get<double>();
+    }
+    weights = res;
+    return true;
+}
+
+// Запись весов (для утилиты подбора)
+inline bool save_eval_weights(const string& path, const eval_weights& weights)
+{
+    ofstream fout(path);
+    fout << json{ { "Potential", weights.potential }, { "KingNumberOnly", weights.king_number_only },
+                  { "King", weights.king } }
+                .dump(4)
+         << "\n";
+    return bool(fout);
+}
@@ -0,0 +1,41 @@
+#pragma once
+// Проверки для тестов без сторонних библиотек: невыполненная проверка печатает файл, строку и условие,
+// а test_result() в конце main дает код возврата теста (не 0 - тест провален, так его считает ctest).
+#include <iostream>
+
+inline int& check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                                          \
+    do                                                                                                       \
+    {                                                                                                        \
+        if (!(cond))                                                                                         \
+        {                                                                                                    \
+            ++check_failures();                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl;           \
+        }                                                                                                    \
+    } while (0)
+
+// Проверка равенства с печатью обоих значений
+#define CHECK_EQ(a, b)                                                                                       \
+    do                                                                                                       \
+    {                                                                                                        \
+        const auto check_a = (a);                                                                            \
+        const auto check_b = (b);                                                                            \
+        if (!(check_a == check_b))                                                                           \
+        {                                                                                                    \
+            ++check_failures();                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " << check_a    \
+                      << " != " << check_b << std::endl;                                                     \
+        }                                                                                                    \
+    } while (0)
+
+inline int test_result()
+{
+    if (check_failures())
+        std::cerr << check_failures() << " checks failed" << std::endl;
+    return check_failures() ? 1 : 0;
+}
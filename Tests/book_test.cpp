@@ -0,0 +1,186 @@
+// Дебютная книга: записи, записанные в формате Tools/bookgen.cpp, находятся по позиции и цвету,
+// ход из записи проверяется по правилам (невозможный ход и незаконченная серия взятий не возвращаются),
+// поврежденный файл не открывается, а бот берет ход из книги только без случайности и не ниже ее уровня.
+//
+// Запуск: ctest (цель book_test в CMakeLists.txt)
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "../Game/Logic.h"
+#include "Check.h"
+
+// Все ходы цвета целиком: серия взятий - последовательность шагов
+void full_moves(Position& pos, const int sq, vector<bit_move>& steps, vector<vector<bit_move>>& res)
+{
+    MoveList turns;
+    if (!gen_piece_turns(pos, sq, turns))
+    {
+        res.push_back(steps);
+        return;
+    }
+    for (const auto& turn : turns)
+    {
+        const undo_info undo = make_turn(pos, turn);
+        steps.push_back(turn);
+        full_moves(pos, turn.to, steps, res);
+        steps.pop_back();
+        unmake_turn(pos, turn, undo);
+    }
+}
+
+vector<vector<bit_move>> full_moves(Position pos, const bool color)
+{
+    vector<vector<bit_move>> res;
+    MoveList turns;
+    const bool have_beats = gen_turns(pos, color, turns);
+    for (const auto& turn : turns)
+    {
+        if (!have_beats)
+        {
+            res.push_back({ turn });
+            continue;
+        }
+        vector<bit_move> steps{ turn };
+        const undo_info undo = make_turn(pos, turn);
+        full_moves(pos, turn.to, steps, res);
+        unmake_turn(pos, turn, undo);
+    }
+    return res;
+}
+
+// Позиция из случайной партии, где у цвета, который ходит, есть серия хотя бы из двух взятий
+bool find_double_capture(Position& pos, bool& color, vector<bit_move>& series)
+{
+    mt19937 rng(3);
+    for (int game = 0; game < 1000; ++game)
+    {
+        pos = Position::start();
+        color = 0;
+        for (int ply = 0; ply < 80; ++ply, color = !color)
+        {
+            const auto moves = full_moves(pos, color);
+            if (moves.empty())
+                break;
+            for (const auto& move : moves)
+                if (move.size() >= 2)
+                {
+                    series = move;
+                    return true;
+                }
+            for (const auto& step : moves[rng() % moves.size()])
+                make_turn(pos, step);
+        }
+    }
+    return false;
+}
+
+void write_book(const string& path, vector<book_entry> entries, const uint32_t level, const uint32_t version = BOOK_VERSION)
+{
+    sort(entries.begin(), entries.end());
+    const book_header header{ { 'C', 'K', 'B', 'K' }, version, level, 0, entries.size() };
+    ofstream fout(path, ios::binary);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(entries.data()), streamsize(entries.size() * sizeof(book_entry)));
+}
+
+book_entry entry_of(const Position& pos, const bool color, const vector<bit_move>& turns)
+{
+    book_entry entry;
+    CHECK(book_entry::make(zobrist.hash(pos, color), turns, entry));
+    return entry;
+}
+
+bool same_move(const vector<bit_move>& a, const vector<bit_move>& b)
+{
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin());
+}
+
+// Ход бота из позиции pos при настройках NoRandom и уровне level; book_move - взят ли ход из книги
+vector<move_pos> bot_move(const string& book, const bool no_random, const int level, const Position& pos, bool& book_move)
+{
+    Config config(json{ { "Bot",
+                          { { "Book", book },
+                            { "NoRandom", no_random },
+                            { "Tablebase", "" },
+                            { "Nnue", "" },
+                            { "Weights", "" },
+                            { "TTSizeMB", 1 } } } });
+    Logic logic(&config);
+    logic.Max_depth = level;
+    const auto res = logic.find_best_turns(0, pos);
+    book_move = logic.book_move;
+    return res;
+}
+
+int main()
+{
+    const string path = "book_test.bin";
+    const Position start = Position::start();
+    const auto start_moves = full_moves(start, 0);
+    const vector<bit_move> start_move = start_moves[2];
+
+    Position cap_pos;
+    bool cap_color;
+    vector<bit_move> series;
+    CHECK(find_double_capture(cap_pos, cap_color, series));
+
+    // Невозможные ходы: фигуры на клетке нет, серия взятий не закончена, тихий ход с лишним шагом
+    Position bad_from = start;
+    make_turn(bad_from, start_move[0]);
+    const book_entry no_piece = entry_of(bad_from, 1, { bit_move(20, 16) });
+    Position quiet_pos = start;
+    for (const auto& step : start_moves[0])
+        make_turn(quiet_pos, step);
+    const auto quiet_moves = full_moves(quiet_pos, 1);
+    vector<bit_move> quiet_extra = quiet_moves[0];
+    quiet_extra.push_back(bit_move(quiet_extra[0].to, quiet_extra[0].from));
+
+    write_book(path,
+               { entry_of(start, 0, start_move), entry_of(cap_pos, cap_color, series), no_piece,
+                 entry_of(quiet_pos, 1, quiet_extra) },
+               6);
+    OpeningBook book;
+    CHECK(book.load(path));
+    CHECK_EQ(book.level(), 6);
+    vector<bit_move> turns;
+    CHECK(book.probe(start, 0, turns) && same_move(turns, start_move));
+    CHECK(!book.probe(start, 1, turns) && turns.empty()); // Другой цвет - другая позиция
+    CHECK(book.probe(cap_pos, cap_color, turns) && same_move(turns, series));
+    CHECK(!book.probe(bad_from, 1, turns));
+    CHECK(!book.probe(quiet_pos, 1, turns));
+
+    // Серия взятий, оборванная на первом шаге
+    write_book(path, { entry_of(cap_pos, cap_color, { series[0] }) }, 6);
+    CHECK(book.load(path));
+    CHECK(!book.probe(cap_pos, cap_color, turns));
+
+    // Поврежденные файлы
+    write_book(path, { entry_of(start, 0, start_move) }, 6, BOOK_VERSION + 1);
+    CHECK(!book.load(path));
+    {
+        write_book(path, { entry_of(start, 0, start_move) }, 6);
+        ifstream fin(path, ios::binary);
+        string data((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+        fin.close();
+        ofstream(path, ios::binary).write(data.data(), streamsize(data.size() - 1));
+    }
+    CHECK(!book.load(path));
+    CHECK(!book.load(path + ".missing"));
+
+    // Бот: книга только без случайности и на уровне не ниже уровня книги
+    write_book(path, { entry_of(start, 0, start_move) }, 6);
+    const move_pos expected = start_move[0].to_move_pos();
+    bool book_move;
+    auto res = bot_move(path, true, 6, start, book_move);
+    CHECK(book_move && res.size() == 1 && res[0] == expected);
+    bot_move(path, true, 4, start, book_move);
+    CHECK(!book_move);
+    bot_move(path, false, 6, start, book_move);
+    CHECK(!book_move);
+    bot_move("", true, 6, start, book_move);
+    CHECK(!book_move);
+
+    remove(path.c_str());
+    return test_result();
+}
@@ -0,0 +1,86 @@
+// Разбор настроек: значения по умолчанию, чтение всех типов и сообщения об ошибках
+// (неверный тип, отрицательное или слишком большое число, неизвестное значение перечисления).
+//
+// Запуск: ctest (цель config_test в CMakeLists.txt)
+#include <string>
+
+#include "../Game/Config.h"
+#include "Check.h"
+
+// Ошибка разбора настроек (пустая строка - настройки верны)
+string parse_error(const json& config)
+{
+    try
+    {
+        Config check(config);
+    }
+    catch (const runtime_error& e)
+    {
+        return e.what();
+    }
+    return "";
+}
+
+int main()
+{
+    // Отсутствующие настройки берут значения по умолчанию
+    const Settings defaults = Config(json::object()).get();
+    CHECK(!defaults.bot.is_bot[0] && defaults.bot.is_bot[1]);
+    CHECK(defaults.bot.scoring == ScoringType::NumberAndPotential);
+    CHECK(defaults.bot.optimization == Optimization::O1);
+    CHECK_EQ(defaults.bot.tt_size_mb, size_t(16));
+    CHECK(defaults.bot.book.empty());
+    CHECK(defaults.bot.ponder);
+    CHECK_EQ(defaults.game.max_num_turns, 120);
+
+    const json config = json::parse(R"({
+        "WindowSize": { "Width": 800, "Hight": 600 },
+        "Bot": { "IsWhiteBot": true, "IsBlackBot": false, "WhiteBotLevel": 7, "BotScoringType": "Nnue",
+                 "NoRandom": true, "Optimization": "O0", "TTSizeMB": 0, "BotTimeMS": 1500, "BotNodes": 100000,
+                 "Threads": 0, "Tablebase": "", "Book": "book.bin", "Ponder": false },
+        "Game": { "MaxNumTurns": 80, "LogLevel": "Debug" }
+    })");
+    const Settings s = Config(config).get();
+    CHECK_EQ(s.window.width, 800u);
+    CHECK_EQ(s.window.height, 600u);
+    CHECK(s.bot.is_bot[0] && !s.bot.is_bot[1]);
+    CHECK_EQ(s.bot.level[0], 7);
+    CHECK_EQ(s.bot.level[1], 5);
+    CHECK(s.bot.scoring == ScoringType::Nnue);
+    CHECK(s.bot.no_random);
+    CHECK(s.bot.optimization == Optimization::O0);
+    CHECK_EQ(s.bot.tt_size_mb, size_t(0));
+    CHECK_EQ(s.bot.time_ms, 1500LL);
+    CHECK_EQ(s.bot.nodes, size_t(100000));
+    CHECK_EQ(s.bot.threads, 0);
+    CHECK(s.bot.tablebase.empty());
+    CHECK_EQ(s.bot.book, string("book.bin"));
+    CHECK(!s.bot.ponder);
+    CHECK_EQ(s.game.max_num_turns, 80);
+    CHECK(s.game.log_level == LogLevel::Debug);
+
+    // Ошибки
+    CHECK_EQ(parse_error(json::array()), string("Bad settings: settings must be a JSON object"));
+    CHECK_EQ(parse_error({ { "Bot", { { "NoRandom", 1 } } } }),
+             string("Bad settings: Bot.NoRandom: expected true or false, got 1"));
+    CHECK_EQ(parse_error({ { "Bot", { { "WhiteBotLevel", -3 } } } }),
+             string("Bad settings: Bot.WhiteBotLevel: expected a non-negative integer, got -3"));
+    CHECK_EQ(parse_error({ { "Bot", { { "BotDelayMS", 1.5 } } } }),
+             string("Bad settings: Bot.BotDelayMS: expected a non-negative integer, got 1.5"));
+    CHECK_EQ(parse_error({ { "WindowSize", { { "Width", 5000000000ull } } } }),
+             string("Bad settings: WindowSize.Width: expected a non-negative integer, got 5000000000"));
+    CHECK_EQ(parse_error({ { "Bot", { { "Book", false } } } }),
+             string("Bad settings: Bot.Book: expected a string, got false"));
+    CHECK_EQ(parse_error({ { "Bot", { { "BotScoringType", "Fast" } } } }),
+             string("Bad settings: Bot.BotScoringType: expected \"NumberOnly\", \"NumberAndPotential\" or \"Nnue\""));
+    CHECK_EQ(parse_error({ { "Bot", { { "Optimization", "O3" } } } }),
+             string("Bad settings: Bot.Optimization: expected \"O0\", \"O1\" or \"O2\""));
+    CHECK_EQ(parse_error({ { "Game", { { "LogLevel", "Trace" } } } }),
+             string("Bad settings: Game.LogLevel: expected \"Debug\", \"Info\", \"Warning\" or \"Error\""));
+
+    // Все ошибки собираются в одно сообщение
+    CHECK_EQ(parse_error({ { "Bot", { { "Threads", "all" }, { "Ponder", "yes" } } } }),
+             string("Bad settings: Bot.Threads: expected a non-negative integer, got \"all\"; "
+                    "Bot.Ponder: expected true or false, got \"yes\""));
+    return test_result();
+}
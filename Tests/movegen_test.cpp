@@ -0,0 +1,86 @@
+// Генератор ходов: perft из нескольких позиций сравнивается с числами, посчитанными исходным генератором
+// по матрице доски, а в каждом узле проверяется, что make_turn обновляет счетчики позиции так же,
+// как их пересчет refresh(), и что unmake_turn возвращает позицию целиком (маски, счетчики, хеш).
+//
+// Запуск: ctest (цель movegen_test в CMakeLists.txt)
+#include <string>
+
+#include "../Game/Bitboard.h"
+#include "Check.h"
+
+// Полное совпадение позиций, включая то, что Position::operator== не сравнивает
+bool same_state(const Position& a, const Position& b)
+{
+    for (int color = 0; color < 2; ++color)
+        if (a.men_count[color] != b.men_count[color] || a.kings_count[color] != b.kings_count[color] ||
+            a.potential[color] != b.potential[color])
+            return false;
+    return a == b && a.key == b.key;
+}
+
+size_t perft(Position& pos, const bool color, const int depth);
+
+// Шаг хода с проверками make/unmake; серия взятий продолжается тем же цветом
+size_t perft_turn(Position& pos, const bool color, const int depth, const bit_move turn)
+{
+    const Position before = pos;
+    const undo_info undo = make_turn(pos, turn);
+    Position recount = pos;
+    recount.refresh();
+    CHECK(same_state(pos, recount));
+    size_t nodes = 0;
+    MoveList turns;
+    if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+    {
+        for (const auto& next : turns)
+            nodes += perft_turn(pos, color, depth, next);
+    }
+    else
+        nodes = perft(pos, !color, depth - 1);
+    unmake_turn(pos, turn, undo);
+    CHECK(same_state(pos, before));
+    return nodes;
+}
+
+size_t perft(Position& pos, const bool color, const int depth)
+{
+    if (depth == 0)
+        return 1;
+    MoveList turns;
+    gen_turns(pos, color, turns);
+    size_t nodes = 0;
+    for (const auto& turn : turns)
+        nodes += perft_turn(pos, color, depth, turn);
+    return nodes;
+}
+
+// Позиция, цвет, который ходит, и perft на глубинах 1, 2, ...
+struct perft_case
+{
+    const char* board;
+    bool color;
+    vector<size_t> nodes;
+};
+
+const perft_case cases[] = {
+    { "bbbbbbbbbbbb........wwwwwwwwwwww", 0, { 7, 49, 302, 1469, 7482, 37986, 190146, 929984 } },
+    { "bbbbbbbbb..w.bb.w...w.w.wwwwwwww", 0, { 1, 6, 49, 302, 2181, 12368 } },
+    { "bbbbb.bb..bww.b..b.www....wwwwww", 0, { 11, 33, 138, 695, 3439, 16354 } },
+    { ".b.b..B.....b.w...W.....w.w.....", 1, { 11, 106, 745, 5780, 38796, 271960 } },
+    { "W.......................B...B...", 0, { 7, 51, 394, 4372, 31716, 351819 } },
+};
+
+int main()
+{
+    for (const auto& c : cases)
+    {
+        Position pos;
+        CHECK(Position::from_string(c.board, pos));
+        const Position start = pos;
+        for (size_t depth = 1; depth <= c.nodes.size(); ++depth)
+            CHECK_EQ(perft(pos, c.color, int(depth)), c.nodes[depth - 1]);
+        CHECK(same_state(pos, start));
+    }
+    CHECK(Position::start().to_string() == string(cases[0].board));
+    return test_result();
+}
@@ -0,0 +1,128 @@
+// Нейросетевая оценка на случайных весах: в случайных партиях аккумулятор, обновляемый на каждом шаге
+// хода (путь AVX2, если он есть), совпадает с посчитанным с нуля, а выход пути AVX2 - со скалярным;
+// сеть записывается и читается без изменений, а ошибки файла описываются в сообщении.
+//
+// Запуск: ctest (цель nnue_test в CMakeLists.txt)
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "../Game/Nnue.h"
+#include "Check.h"
+
+// Случайные веса: активации первого слоя попадают и в ноль, и выше NNUE_QA, веса int8 - во весь диапазон
+void random_weights(Nnue& nnue, mt19937& rng)
+{
+    auto uniform = [&rng](const int low, const int high) { return uniform_int_distribution<int>(low, high)(rng); };
+    for (auto& b : nnue.w.l1_bias)
+        b = int16_t(uniform(-100, 100));
+    for (auto& column : nnue.w.l1_weights)
+        for (auto& v : column)
+            v = int16_t(uniform(-60, 60));
+    for (auto& b : nnue.w.l2_bias)
+        b = uniform(-4000, 4000);
+    for (auto& row : nnue.w.l2_weights)
+        for (auto& v : row)
+            v = int8_t(uniform(-128, 127));
+    for (auto& v : nnue.w.l3_weights)
+        v = int8_t(uniform(-128, 127));
+    nnue.w.l3_bias = uniform(-1000, 1000);
+}
+
+bool same_accumulator(const nnue_accumulator& a, const nnue_accumulator& b)
+{
+    return equal(begin(a.v), end(a.v), begin(b.v));
+}
+
+void check_forward(const Nnue& nnue, const nnue_accumulator& acc, size_t& clamped)
+{
+    for (const int16_t v : acc.v)
+        clamped += v < 0 || v > NNUE_QA;
+#ifdef EVAL_HAS_AVX2_PATH
+    if (cpu_has_avx2())
+        CHECK_EQ(nnue.forward_avx2(acc), nnue.forward_scalar(acc));
+#endif
+    CHECK_EQ(nnue.forward(acc), nnue.forward_scalar(acc));
+}
+
+// Случайные партии: аккумулятор по шагам против пересчета с нуля
+void check_accumulator(const Nnue& nnue, mt19937& rng)
+{
+    size_t clamped = 0; // Активации, которые ограничивает ReLU (проверка, что ограничение участвует)
+    for (int game = 0; game < 50; ++game)
+    {
+        Position pos = Position::start();
+        nnue_accumulator acc;
+        nnue.refresh(pos, acc);
+        check_forward(nnue, acc, clamped);
+        bool color = 0;
+        int sq = -1;
+        for (int step = 0; step < 150; ++step)
+        {
+            MoveList turns;
+            if (sq == -1)
+                gen_turns(pos, color, turns);
+            else if (!gen_piece_turns(pos, sq, turns))
+            {
+                sq = -1;
+                color = !color;
+                gen_turns(pos, color, turns);
+            }
+            if (turns.empty())
+                break;
+            const bit_move turn = turns[int(rng() % turns.size())];
+            const undo_info undo = make_turn(pos, turn);
+            nnue_accumulator next, fresh;
+            nnue.update(acc, pos, turn, undo, next);
+            nnue.refresh(pos, fresh);
+            CHECK(same_accumulator(next, fresh));
+            check_forward(nnue, next, clamped);
+            acc = next;
+            if (turn.cap != -1)
+                sq = turn.to;
+            else
+                color = !color;
+        }
+    }
+    CHECK(clamped > 0);
+}
+
+void check_file(Nnue& nnue)
+{
+    const string path = "nnue_test.bin";
+    CHECK(nnue.save(path));
+    Nnue loaded;
+    string error = "not cleared";
+    CHECK(loaded.load(path, error));
+    CHECK(error.empty());
+    CHECK(memcmp(&loaded.w, &nnue.w, sizeof(nnue.w)) == 0);
+
+    ofstream(path, ios::binary | ios::app).put(0); // Лишний байт
+    CHECK(!loaded.load(path, error));
+    CHECK_EQ(error, path + ": wrong file size");
+    ofstream(path, ios::binary).write("CKNN\x02\0\0\0", 8);
+    CHECK(!loaded.load(path, error));
+    CHECK_EQ(error, path + ": not a network file of this version");
+    remove(path.c_str());
+    CHECK(!loaded.load(path, error));
+    CHECK_EQ(error, path + ": cannot open");
+}
+
+int main()
+{
+    mt19937 rng(11);
+    Nnue nnue;
+    random_weights(nnue, rng);
+    check_accumulator(nnue, rng);
+    check_file(nnue);
+
+    // Позиция без фигур одной стороны - выигрыш или проигрыш без сети
+    Position pos;
+    CHECK(Position::from_string("w...............................", pos));
+    nnue_accumulator acc;
+    nnue.refresh(pos, acc);
+    CHECK_EQ(nnue.score(acc, pos, 0), WIN_SCORE);
+    CHECK_EQ(nnue.score(acc, pos, 1), -WIN_SCORE);
+    return test_result();
+}
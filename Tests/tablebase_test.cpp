@@ -0,0 +1,122 @@
+// Эндшпильные таблицы: файл, построенный Tools/tbgen.cpp, открывается, и для каждой позиции каждого
+// материала результат таблицы согласован с результатами позиций после всех ходов (серия взятий - один ход):
+// выигрыш - если есть ход в проигрыш соперника (расстояние - до ближайшего), проигрыш - если все ходы
+// ведут к выигрышу соперника (до самого дальнего), иначе ничья. Поврежденный файл не открывается.
+//
+// Запуск: ctest (цель tablebase_test в CMakeLists.txt; таблицы до 3 фигур строит тест tbgen_3)
+//         ./tablebase_test FILE
+#include <fstream>
+#include <string>
+
+#include "../Game/Tablebase.h"
+#include "Check.h"
+
+// Результат, который следует из результатов позиций после всех ходов цвета color
+tb_result expected_result(const Tablebase& tb, Position pos, const bool color)
+{
+    int min_loss = -1; // Наименьшее расстояние до проигрыша соперника
+    int max_win = -1; // Наибольшее расстояние до выигрыша соперника
+    bool all_win = true;
+    auto visit = [&](const Position& next) {
+        tb_result child;
+        CHECK(tb.probe(next, !color, child));
+        if (child.value < 0)
+            min_loss = min_loss < 0 ? child.dist : min(min_loss, child.dist);
+        else if (child.value > 0)
+            max_win = max(max_win, child.dist);
+        else
+            all_win = false;
+    };
+    auto play = [&](auto& self, const bit_move turn) -> void {
+        const undo_info undo = make_turn(pos, turn);
+        MoveList turns;
+        if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+        {
+            for (const auto& next : turns)
+                self(self, next);
+        }
+        else
+            visit(pos);
+        unmake_turn(pos, turn, undo);
+    };
+    MoveList turns;
+    gen_turns(pos, color, turns);
+    for (const auto& turn : turns)
+        play(play, turn);
+    if (min_loss >= 0)
+        return { 1, min_loss + 1 };
+    if (all_win) // В том числе, если ходов нет
+        return { -1, max_win + 1 };
+    return { 0, 0 };
+}
+
+// Поврежденный файл: первые size байт настоящего файла
+bool loads_truncated(const string& path, const size_t size)
+{
+    ifstream fin(path, ios::binary);
+    string data(size, '\0');
+    fin.read(&data[0], streamsize(size));
+    const string cut = path + ".cut";
+    ofstream(cut, ios::binary).write(data.data(), streamsize(size));
+    Tablebase tb;
+    const bool res = tb.load(cut);
+    remove(cut.c_str());
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    const string path = argc > 1 ? argv[1] : "tablebase.bin";
+    Tablebase tb;
+    if (!tb.load(path))
+    {
+        cerr << "Cannot load " << path << endl;
+        return 1;
+    }
+    const int pieces = tb.pieces();
+    CHECK(pieces >= 2 && pieces <= TB_MAX_PIECES);
+
+    size_t positions = 0;
+    for (int wm = 0; wm <= pieces; ++wm)
+        for (int wk = 0; wm + wk <= pieces; ++wk)
+            for (int bm = 0; wm + wk + bm <= pieces; ++bm)
+                for (int bk = 0; wm + wk + bm + bk <= pieces; ++bk)
+                {
+                    const tb_material m{ wm, wk, bm, bk };
+                    if (!(wm + wk) || !(bm + bk))
+                        continue;
+                    for (uint64_t idx = 0; idx < tb_size(m); ++idx)
+                    {
+                        Position pos;
+                        if (!tb_position(m, idx, pos))
+                            continue;
+                        for (int color = 0; color < 2; ++color)
+                        {
+                            tb_result res;
+                            CHECK(tb.probe(pos, color, res));
+                            const tb_result expected = expected_result(tb, pos, color);
+                            if (res.value != expected.value || res.dist != expected.dist)
+                            {
+                                CHECK_EQ(res.value, expected.value);
+                                CHECK_EQ(res.dist, expected.dist);
+                                cerr << "  position " << pos.to_string() << ", color " << color << endl;
+                            }
+                        }
+                        ++positions;
+                    }
+                }
+    CHECK(positions > 0);
+
+    // Позиции с большим числом фигур в таблицах нет
+    tb_result res;
+    CHECK(!tb.probe(Position::start(), 0, res));
+
+    ifstream fin(path, ios::binary | ios::ate);
+    const size_t size = size_t(fin.tellg());
+    CHECK(!loads_truncated(path, 8));
+    CHECK(!loads_truncated(path, size - 1));
+    CHECK(loads_truncated(path, size));
+    CHECK(!tb.load(path + ".missing"));
+    CHECK_EQ(tb.pieces(), 0);
+    return test_result();
+}
@@ -0,0 +1,108 @@
+// Хеш Зобриста и таблица транспозиций: в случайных партиях хеш, обновляемый make_turn/unmake_turn,
+// совпадает с пересчитанным refresh() и возвращается к исходному после отмены всех ходов;
+// запись таблицы возвращает те же оценку (24 бита со знаком), глубину, тип оценки и ход.
+//
+// Запуск: ctest (цель tt_test в CMakeLists.txt)
+#include <random>
+
+#include "../Game/TT.h"
+#include "Check.h"
+
+// Случайные партии до 150 шагов: хеш после каждого шага и после отмены всей партии
+void check_zobrist()
+{
+    mt19937 rng(7);
+    for (int game = 0; game < 200; ++game)
+    {
+        Position pos = Position::start();
+        const uint64_t start_key = pos.key;
+        vector<pair<bit_move, undo_info>> done;
+        bool color = 0;
+        int sq = -1; // Клетка фигуры, продолжающей серию взятий
+        for (int step = 0; step < 150; ++step)
+        {
+            MoveList turns;
+            if (sq == -1)
+                gen_turns(pos, color, turns);
+            else if (!gen_piece_turns(pos, sq, turns)) // Серия взятий закончена - ходит соперник
+            {
+                sq = -1;
+                color = !color;
+                gen_turns(pos, color, turns);
+            }
+            if (turns.empty())
+                break;
+            const bit_move turn = turns[int(rng() % turns.size())];
+            done.emplace_back(turn, make_turn(pos, turn));
+            Position recount = pos;
+            recount.refresh();
+            CHECK_EQ(pos.key, recount.key);
+            CHECK(zobrist.hash(pos, 0) != zobrist.hash(pos, 1));
+            if (turn.cap != -1)
+                sq = turn.to;
+            else
+                color = !color;
+        }
+        for (auto it = done.rbegin(); it != done.rend(); ++it)
+            unmake_turn(pos, it->first, it->second);
+        CHECK(pos == Position::start());
+        CHECK_EQ(pos.key, start_key);
+    }
+}
+
+// Запись и чтение одной записи
+void check_entry(TranspositionTable& tt, const uint64_t key, const int depth, const Bound bound, const int score,
+                 const bit_move move)
+{
+    tt.store(key, depth, bound, score, move);
+    tt_entry entry;
+    CHECK(tt.probe(key, entry));
+    CHECK_EQ(entry.key, key);
+    CHECK_EQ(entry.score, score);
+    CHECK_EQ(int(entry.depth), min(depth, TranspositionTable::MAX_DEPTH));
+    CHECK(entry.bound == bound);
+    CHECK(entry.move == move);
+}
+
+void check_table()
+{
+    TranspositionTable tt;
+    tt_entry entry;
+    tt.store(1, 5, Bound::EXACT, 7, bit_move(1, 5)); // Таблица отключена: запись ничего не делает
+    CHECK(!tt.probe(1, entry));
+
+    tt.resize(1);
+    const int scores[] = { 0, 1, -1, 999, -999, WIN_SCORE, -WIN_SCORE, WIN_SCORE - 37, -WIN_SCORE + 37, (1 << 23) - 1,
+                           -(1 << 23) };
+    uint64_t key = 0x9E3779B97F4A7C15ull;
+    for (const int score : scores)
+    {
+        key = key * 6364136223846793005ull + 1442695040888963407ull;
+        check_entry(tt, key, 3, Bound::EXACT, score, bit_move(9, 13));
+        key = key * 6364136223846793005ull + 1442695040888963407ull;
+        check_entry(tt, key, 0, Bound::LOWER, score, bit_move(31, 22, 26));
+        key = key * 6364136223846793005ull + 1442695040888963407ull;
+        check_entry(tt, key, TranspositionTable::MAX_DEPTH, Bound::UPPER, score, bit_move());
+    }
+
+    // Глубина больше MAX_DEPTH сохраняется как MAX_DEPTH
+    check_entry(tt, 12345, 500, Bound::EXACT, -42, bit_move(0, 4));
+
+    // Более мелкий результат той же позиции не затирает глубокий, другой позиции - затирает
+    tt.store(12345, 2, Bound::LOWER, 5, bit_move(1, 5));
+    CHECK(tt.probe(12345, entry));
+    CHECK_EQ(entry.score, -42);
+    const uint64_t other = 12345 + (uint64_t(1) << 40); // Та же ячейка, другой хеш
+    check_entry(tt, other, 1, Bound::LOWER, 5, bit_move(1, 5));
+    CHECK(!tt.probe(12345, entry));
+
+    tt.clear();
+    CHECK(!tt.probe(other, entry));
+}
+
+int main()
+{
+    check_zobrist();
+    check_table();
+    return test_result();
+}
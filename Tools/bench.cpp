@@ -0,0 +1,284 @@
+// Бенчмарк горячих участков движка без окна SDL: генерация ходов, выполнение и отмена хода,
+// оценка позиции (в том числе пачкой: скалярный путь и AVX2), поиск лучшего хода на фиксированных глубинах
+// и ответ после размышления на времени соперника по фиксированному набору позиций.
+// Каждый замер печатается отдельной строкой JSON, чтобы сравнивать сборки между собой.
+//
+// Сборка: g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/bench.cpp -o bench
+// Запуск: ./bench [--iters N] [--depths 4,6,8] [--threads N] [--nnue FILE]
+//   --iters   - число повторов в микробенчмарках (по умолчанию 1000000)
+//   --depths  - глубины поиска (уровни бота) для замеров find_best_turns
+//   --threads - число потоков для замера ускорения поиска относительно одного потока (по умолчанию 1 - без замера)
+//   --nnue    - файл нейросетевой оценки: добавляются замеры calc_score и поиска в режиме Nnue
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Game/Logic.h"
+
+// Позиции для замеров: строка клеток в формате Position::from_string и цвет, который ходит
+struct bench_position
+{
+    const char* name;
+    const char* board;
+    bool color;
+};
+
+const bench_position positions[] = {
+    { "start", "bbbbbbbbbbbb........wwwwwwwwwwww", 0 },
+    { "opening", "bbbbbbbbb..w.bb.w...w.w.wwwwwwww", 0 },
+    { "middlegame", "bbbbb.bb..bww.b..b.www....wwwwww", 0 },
+    { "middlegame_2", ".b.bbbbb...b....b..w..wwww.ww...", 0 },
+    { "late", "b..bb......bwwb.......www.www...", 0 },
+    { "kings", ".b.b..B.....b.w...W.....w.w.....", 1 },
+    { "kings_endgame", "W.......................B...B...", 0 },
+};
+
+volatile double sink; // Результаты замеров, чтобы компилятор не выбросил вычисления
+string nnue_file; // Файл нейросетевой оценки (пустая строка - без замеров режима Nnue)
+
+// Настройки бота для замеров: детерминированный поиск без бюджета
+Config make_config(const string& scoring_mode, const int threads, const string& nnue = "")
+{
+    return Config(json{ { "Bot",
+                          { { "NoRandom", true },
+                            { "BotScoringType", scoring_mode },
+                            { "Optimization", "O1" },
+                            { "TTSizeMB", 16 },
+                            { "BotTimeMS", 0 },
+                            { "BotNodes", 0 },
+                            { "Threads", threads },
+                            { "Tablebase", "" },
+                            { "Book", "" },
+                            { "Nnue", nnue },
+                            { "Weights", "" } } } });
+}
+
+double seconds_since(const chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void report(const json& record)
+{
+    cout << record.dump() << endl;
+}
+
+// Время поиска на глубине level и число просмотренных узлов
+pair<double, size_t> time_search(const Position& pos, const bool color, const int level, const int threads,
+                                 const string& scoring_mode = "NumberAndPotential")
+{
+    Config config = make_config(scoring_mode, threads, nnue_file);
+    Logic logic(&config);
+    logic.Max_depth = level;
+    const auto start = chrono::steady_clock::now();
+    auto turns = logic.find_best_turns(color, pos);
+    const double time = seconds_since(start);
+    sink = sink + turns.size();
+    return { time, logic.nodes };
+}
+
+// Ответ после размышления: бот находит ход в позиции, начинает размышление, и соперник сразу делает
+// предсказанный ход. Ответ должен быть досчитан до той же глубины, что и обычный поиск этой позиции.
+// false, если размышление не началось (нет ходов или предсказания)
+bool time_ponder_hit(const bench_position& bp, Position pos, const int level, json& record)
+{
+    Config config = make_config("NumberAndPotential", 1);
+    Logic logic(&config);
+    logic.Max_depth = level;
+    for (const auto& turn : logic.find_best_turns(bp.color, pos))
+        make_turn(pos, bit_move(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2),
+                                turn.xb == -1 ? -1 : sq_index(turn.xb, turn.yb)));
+    logic.start_ponder(bp.color, pos);
+    if (!logic.ponder_position(pos))
+        return false;
+    const auto start = chrono::steady_clock::now();
+    auto turns = logic.find_best_turns(bp.color, pos);
+    const double time = seconds_since(start);
+    sink = sink + turns.size();
+
+    Logic fresh(&config);
+    fresh.Max_depth = level;
+    fresh.find_best_turns(bp.color, pos);
+    record = { { "bench", "ponder_hit" }, { "position", bp.name }, { "level", level }, { "hit", logic.ponder_hit },
+               { "depth", logic.completed_depth }, { "search_depth", fresh.completed_depth }, { "ms", time * 1e3 } };
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iters = 1000000;
+    vector<int> depths = { 4, 6, 8 };
+    int threads = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--iters")
+            iters = stoul(argv[i + 1]);
+        else if (arg == "--nnue")
+            nnue_file = argv[i + 1];
+        else if (arg == "--threads")
+            threads = stoi(argv[i + 1]);
+        else if (arg == "--depths")
+        {
+            depths.clear();
+            stringstream ss(argv[i + 1]);
+            for (string depth; getline(ss, depth, ',');)
+                depths.push_back(stoi(depth));
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    Config config_number = make_config("NumberOnly", 1);
+    Config config_potential = make_config("NumberAndPotential", 1);
+    Config config_nnue = make_config("Nnue", 1, nnue_file);
+    Logic logic_number(&config_number);
+    Logic logic_potential(&config_potential);
+    Logic logic_nnue(&config_nnue);
+    vector<pair<Logic*, const char*>> eval_modes = { { &logic_number, "NumberOnly" },
+                                                     { &logic_potential, "NumberAndPotential" } };
+    if (!nnue_file.empty())
+        eval_modes.emplace_back(&logic_nnue, "Nnue");
+
+    for (const auto& bp : positions)
+    {
+        Position pos;
+        if (!Position::from_string(bp.board, pos))
+        {
+            cerr << "Bad position " << bp.name << endl;
+            return 1;
+        }
+        MoveList turns;
+        gen_turns(pos, bp.color, turns);
+
+        // Генерация всех ходов цвета
+        auto start = chrono::steady_clock::now();
+        size_t total = 0;
+        for (size_t i = 0; i < iters; ++i)
+        {
+            MoveList list;
+            gen_turns(pos, (i & 1) ? !bp.color : bp.color, list);
+            total += list.size();
+        }
+        double time = seconds_since(start);
+        sink = sink + total;
+        report({ { "bench", "find_turns" }, { "position", bp.name }, { "calls", iters },
+                 { "ns_per_call", time * 1e9 / iters }, { "moves_per_sec", total / time } });
+
+        // Выполнение и отмена каждого хода позиции
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < iters; ++i)
+        {
+            const bit_move turn = turns[int(i % turns.size())];
+            const undo_info undo = make_turn(pos, turn);
+            total += pos.kings;
+            unmake_turn(pos, turn, undo);
+        }
+        time = seconds_since(start);
+        sink = sink + total;
+        report({ { "bench", "make_turn" }, { "position", bp.name }, { "calls", iters },
+                 { "ns_per_call", time * 1e9 / iters } });
+
+        // Оценка позиции в каждом режиме подсчета
+        for (const auto& [logic, mode] : eval_modes)
+        {
+            start = chrono::steady_clock::now();
+            double score = 0;
+            for (size_t i = 0; i < iters; ++i)
+                score += logic->calc_score(pos, i & 1);
+            time = seconds_since(start);
+            sink = sink + score;
+            report({ { "bench", "calc_score" }, { "mode", mode }, { "position", bp.name }, { "calls", iters },
+                     { "ns_per_call", time * 1e9 / iters } });
+        }
+
+        // Оценка пачки потомков позиции по маскам: ядро на каждом пути и полная оценка пачки,
+        // результат которой должен совпасть с calc_score по счетчикам позиции
+        vector<Position> children;
+        for (const auto& turn : turns)
+        {
+            Position child = pos;
+            make_turn(child, turn);
+            children.push_back(child);
+        }
+        for (size_t i = 0; children.size() < 256; ++i)
+            children.push_back(children[i]);
+        const size_t batches = max<size_t>(1, iters / children.size());
+        vector<eval_terms> terms(children.size());
+        auto time_kernel = [&](const char* path, void (*kernel)(const Position*, size_t, eval_terms*)) {
+            const auto kernel_start = chrono::steady_clock::now();
+            for (size_t i = 0; i < batches; ++i)
+                kernel(children.data(), children.size(), terms.data());
+            const double kernel_time = seconds_since(kernel_start);
+            sink = sink + terms[0].potential[0];
+            report({ { "bench", "eval_terms" }, { "path", path }, { "position", bp.name },
+                     { "positions", batches * children.size() },
+                     { "ns_per_position", kernel_time * 1e9 / (batches * children.size()) } });
+        };
+        time_kernel("scalar", eval_terms_scalar);
+#ifdef EVAL_HAS_AVX2_PATH
+        if (cpu_has_avx2())
+            time_kernel("avx2", eval_terms_avx2);
+#endif
+        vector<int> scores(children.size());
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < batches; ++i)
+            logic_potential.calc_scores(children.data(), children.size(), i & 1, scores.data());
+        time = seconds_since(start);
+        sink = sink + scores[0];
+        report({ { "bench", "calc_scores" }, { "mode", "NumberAndPotential" }, { "position", bp.name },
+                 { "positions", batches * children.size() },
+                 { "ns_per_position", time * 1e9 / (batches * children.size()) } });
+        for (auto* logic : { &logic_number, &logic_potential })
+        {
+            logic->calc_scores(children.data(), children.size(), bp.color, scores.data());
+            for (size_t i = 0; i < children.size(); ++i)
+                if (scores[i] != logic->calc_score(children[i], bp.color))
+                {
+                    cerr << "Batch score differs from calc_score in " << bp.name << endl;
+                    return 1;
+                }
+        }
+
+        // Поиск на фиксированных глубинах (и ускорение на нескольких потоках)
+        for (int level : depths)
+        {
+            const auto single = time_search(pos, bp.color, level, 1);
+            json record = { { "bench", "find_best_turns" }, { "position", bp.name }, { "level", level },
+                            { "nodes", single.second }, { "ms", single.first * 1e3 },
+                            { "nodes_per_sec", single.second / single.first } };
+            if (threads > 1)
+            {
+                const auto parallel = time_search(pos, bp.color, level, threads);
+                record["threads"] = threads;
+                record["parallel_ms"] = parallel.first * 1e3;
+                record["parallel_nodes"] = parallel.second;
+                record["speedup"] = single.first / parallel.first;
+            }
+            report(record);
+            if (!nnue_file.empty())
+            {
+                const auto nnue = time_search(pos, bp.color, level, 1, "Nnue");
+                report({ { "bench", "find_best_turns" }, { "mode", "Nnue" }, { "position", bp.name }, { "level", level },
+                         { "nodes", nnue.second }, { "ms", nnue.first * 1e3 }, { "nodes_per_sec", nnue.second / nnue.first } });
+            }
+            json ponder_record;
+            if (time_ponder_hit(bp, pos, level, ponder_record))
+            {
+                report(ponder_record);
+                if (!ponder_record["hit"] || ponder_record["depth"] != ponder_record["search_depth"])
+                {
+                    cerr << "Ponder hit is not searched to the bot level in " << bp.name << endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Построение дебютной книги: все позиции, которые получаются из начальной за --plies полуходов
+// при любых ходах обеих сторон, просчитываются поиском бота на уровне --level,
+// и найденные ходы записываются в файл книги (формат описан в Game/Book.h).
+// Позиции делятся между потоками, у каждого потока свой бот.
+//
+// Сборка: g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/bookgen.cpp -o bookgen
+// Запуск: ./bookgen [--plies N] [--level N] [--threads N] [--out FILE] [--tablebase FILE]
+//   --plies     - глубина дерева дебюта в полуходах (по умолчанию 4)
+//   --level     - уровень поиска для каждой позиции (по умолчанию 10)
+//   --threads   - число потоков (по умолчанию все ядра)
+//   --out       - файл книги (по умолчанию book.bin, его читает бот по настройке "Book")
+//   --tablebase - файл эндшпильных таблиц для поиска (по умолчанию не используется)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_set>
+
+#include "../Game/Logic.h"
+
+// Позиция дебюта и цвет, который ходит
+struct book_position
+{
+    Position pos;
+    bool color;
+};
+
+// Перебор позиций после всех ходов целиком (с сериями взятий)
+template <class F> void for_each_turn(Position& pos, const bit_move turn, F& visit)
+{
+    const undo_info undo = make_turn(pos, turn);
+    MoveList turns;
+    if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+    {
+        for (const auto& next : turns)
+            for_each_turn(pos, next, visit);
+    }
+    else
+        visit(pos);
+    unmake_turn(pos, turn, undo);
+}
+
+int main(int argc, char* argv[])
+{
+    int plies = 4;
+    int level = 10;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    string out = "book.bin";
+    string tablebase;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--plies")
+            plies = stoi(argv[i + 1]);
+        else if (arg == "--level")
+            level = stoi(argv[i + 1]);
+        else if (arg == "--threads")
+            threads = max(1, stoi(argv[i + 1]));
+        else if (arg == "--out")
+            out = argv[i + 1];
+        else if (arg == "--tablebase")
+            tablebase = argv[i + 1];
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    // Дерево дебюта по уровням: каждая позиция входит один раз
+    vector<book_position> positions;
+    unordered_set<uint64_t> seen;
+    vector<book_position> cur = { { Position::start(), 0 } };
+    seen.insert(zobrist.hash(cur[0].pos, 0));
+    for (int ply = 0; ply <= plies && !cur.empty(); ++ply)
+    {
+        positions.insert(positions.end(), cur.begin(), cur.end());
+        if (ply == plies)
+            break;
+        vector<book_position> next;
+        for (auto bp : cur)
+        {
+            auto visit = [&](const Position& pos) {
+                if (seen.insert(zobrist.hash(pos, !bp.color)).second)
+                    next.push_back({ pos, !bp.color });
+            };
+            MoveList turns;
+            gen_turns(bp.pos, bp.color, turns);
+            for (const auto& turn : turns)
+                for_each_turn(bp.pos, turn, visit);
+        }
+        cur = move(next);
+    }
+    cout << positions.size() << " positions" << endl;
+
+    // Поиск хода для каждой позиции
+    const Config config(json{ { "Bot",
+                                { { "NoRandom", true },
+                                  { "BotScoringType", "NumberAndPotential" },
+                                  { "Optimization", "O1" },
+                                  { "TTSizeMB", 64 },
+                                  { "BotTimeMS", 0 },
+                                  { "BotNodes", 0 },
+                                  { "Threads", 1 },
+                                  { "Tablebase", tablebase },
+                                  { "Book", "" },
+                                  { "Nnue", "" } } } });
+    vector<book_entry> entries;
+    mutex entries_mutex;
+    atomic<size_t> next_position{ 0 };
+    const auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&] {
+            Config thread_config = config;
+            Logic logic(&thread_config);
+            logic.Max_depth = level;
+            for (size_t i; (i = next_position++) < positions.size();)
+            {
+                const book_position& bp = positions[i];
+                vector<bit_move> turns;
+                for (const auto& turn : logic.find_best_turns(bp.color, bp.pos))
+                    turns.emplace_back(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2),
+                                       turn.xb == -1 ? -1 : sq_index(turn.xb, turn.yb));
+                book_entry entry;
+                if (!book_entry::make(zobrist.hash(bp.pos, bp.color), turns, entry))
+                    continue;
+                lock_guard<mutex> lock(entries_mutex);
+                entries.push_back(entry);
+                if (entries.size() % 100 == 0)
+                    cout << entries.size() << " / " << positions.size() << ", "
+                         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+            }
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+
+    // Запись файла: заголовок и записи, отсортированные по хешу
+    sort(entries.begin(), entries.end());
+    ofstream fout(out, ios::binary);
+    const book_header header{ { 'C', 'K', 'B', 'K' }, BOOK_VERSION, uint32_t(level), 0, entries.size() };
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(entries.data()), streamsize(entries.size() * sizeof(book_entry)));
+    if (!fout)
+    {
+        cerr << "Cannot write " << out << endl;
+        return 1;
+    }
+    cout << "Written " << out << ", " << entries.size() << " positions" << endl;
+    return 0;
+}
@@ -0,0 +1,277 @@
+// Обучение нейросетевой оценки (Game/Nnue.h). Позиции набираются из случайных партий, цель для каждой -
+// логарифм отношения материала черных к материалу белых по оценке NumberAndPotential, то есть сеть
+// сначала учится повторять ручную оценку; другие цели (например, результаты партий) подставляются
+// в функцию target. Сеть обучается во float (Adam, среднеквадратичная ошибка) с ограничением весов
+// диапазоном квантования, затем веса округляются и записываются в файл сети. Квантованная сеть
+// проверяется на проверочных позициях: аккумулятор не должен выходить за int16, а выход - далеко
+// отличаться от выхода сети во float.
+//
+// Сборка: g++ -std=c++17 -O2 Tools/nnuetrain.cpp -o nnuetrain
+// Запуск: ./nnuetrain [--positions N] [--epochs N] [--seed N] [--out FILE]
+//   --positions - число позиций для обучения (по умолчанию 200000, из них 5% - для проверки)
+//   --epochs    - число проходов по позициям (по умолчанию 10)
+//   --seed      - начальное значение генератора случайных чисел (по умолчанию 1)
+//   --out       - файл сети (по умолчанию nnue.bin, его читает бот по настройке "Nnue")
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Game/Nnue.h"
+
+// Обучающий пример: номера признаков фигур и цель
+struct train_sample
+{
+    vector<int> features;
+    float target;
+};
+
+// Цель обучения для позиции
+float target(const Position& pos)
+{
+    return float(NumberAndPotentialEval::score(pos, 1, eval_weights())) / SCORE_SCALE; // Логарифм отношения
+}
+
+// Сеть во float с моментами Adam для каждого веса
+struct float_net
+{
+    // Сумма смещения и столбцов всех фигур (до NNUE_MAX_FEATURES) с округлением помещается в int16
+    static constexpr float W1_MAX = float(32767 / (NNUE_QA * (NNUE_MAX_FEATURES + 1)));
+    static constexpr float W_MAX = 127.f / NNUE_QB; // Диапазон весов int8
+
+    vector<float> w1 = vector<float>(NNUE_INPUTS * NNUE_L1), b1 = vector<float>(NNUE_L1);
+    vector<float> w2 = vector<float>(NNUE_L2 * NNUE_L1), b2 = vector<float>(NNUE_L2);
+    vector<float> w3 = vector<float>(NNUE_L2), b3 = vector<float>(1);
+
+    // Прямой проход; h1, h2 - активации для обратного прохода
+    float forward(const train_sample& s, float* a1, float* h1, float* a2, float* h2) const
+    {
+        copy(b1.begin(), b1.end(), a1);
+        for (int f : s.features)
+            for (int i = 0; i < NNUE_L1; ++i)
+                a1[i] += w1[f * NNUE_L1 + i];
+        for (int i = 0; i < NNUE_L1; ++i)
+            h1[i] = clamp(a1[i], 0.f, 1.f);
+        float out = b3[0];
+        for (int j = 0; j < NNUE_L2; ++j)
+        {
+            a2[j] = b2[j];
+            for (int i = 0; i < NNUE_L1; ++i)
+                a2[j] += w2[j * NNUE_L1 + i] * h1[i];
+            h2[j] = clamp(a2[j], 0.f, 1.f);
+            out += w3[j] * h2[j];
+        }
+        return out;
+    }
+};
+
+// Шаг Adam для одного набора весов
+void adam_step(vector<float>& w, const vector<float>& grad, vector<float>& m, vector<float>& v, const float lr,
+               const int t, const float limit)
+{
+    const float b1 = 0.9f, b2 = 0.999f;
+    const float c1 = 1 - pow(b1, float(t)), c2 = 1 - pow(b2, float(t));
+    for (size_t i = 0; i < w.size(); ++i)
+    {
+        m[i] = b1 * m[i] + (1 - b1) * grad[i];
+        v[i] = b2 * v[i] + (1 - b2) * grad[i] * grad[i];
+        w[i] -= lr * (m[i] / c1) / (sqrt(v[i] / c2) + 1e-8f);
+        w[i] = clamp(w[i], -limit, limit);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t positions = 200000;
+    int epochs = 10;
+    unsigned seed = 1;
+    string out = "nnue.bin";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--positions")
+            positions = stoul(argv[i + 1]);
+        else if (arg == "--epochs")
+            epochs = stoi(argv[i + 1]);
+        else if (arg == "--seed")
+            seed = unsigned(stoul(argv[i + 1]));
+        else if (arg == "--out")
+            out = argv[i + 1];
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    // Позиции из случайных партий (без позиций, где у одной из сторон нет фигур)
+    mt19937 rng(seed);
+    vector<train_sample> samples;
+    while (samples.size() < positions)
+    {
+        Position pos = Position::start();
+        bool color = 0;
+        for (int ply = 0; ply < 200 && samples.size() < positions; ++ply)
+        {
+            MoveList turns;
+            gen_turns(pos, color, turns);
+            if (turns.empty())
+                break;
+            bit_move turn = turns[int(rng() % turns.size())];
+            make_turn(pos, turn);
+            while (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns)) // Серия взятий до конца
+            {
+                turn = turns[int(rng() % turns.size())];
+                make_turn(pos, turn);
+            }
+            color = !color;
+            if (!pos.white || !pos.black)
+                break;
+            train_sample s;
+            for (BB b = pos.occupied(); b; b &= b - 1)
+                s.features.push_back(nnue_feature(pos.piece(lsb(b)), lsb(b)));
+            s.target = target(pos);
+            samples.push_back(move(s));
+        }
+    }
+    shuffle(samples.begin(), samples.end(), rng);
+    const size_t valid_count = samples.size() / 20;
+    const vector<train_sample> valid(samples.end() - ptrdiff_t(valid_count), samples.end());
+    samples.resize(samples.size() - valid_count);
+    cout << samples.size() << " training positions, " << valid.size() << " validation positions" << endl;
+
+    // Начальные веса: первый слой в линейной области ограниченного ReLU
+    float_net net;
+    uniform_real_distribution<float> init1(-0.1f, 0.1f), init2(-0.2f, 0.2f);
+    for (auto& x : net.w1)
+        x = init1(rng);
+    fill(net.b1.begin(), net.b1.end(), 0.5f);
+    for (auto& x : net.w2)
+        x = init2(rng);
+    fill(net.b2.begin(), net.b2.end(), 0.5f);
+    for (auto& x : net.w3)
+        x = init2(rng);
+
+    float a1[NNUE_L1], h1[NNUE_L1], a2[NNUE_L2], h2[NNUE_L2];
+    auto loss_on = [&](const vector<train_sample>& set) {
+        double sum = 0;
+        for (const auto& s : set)
+        {
+            const float d = net.forward(s, a1, h1, a2, h2) - s.target;
+            sum += d * d;
+        }
+        return sum / set.size();
+    };
+
+    // Обучение мини-пачками
+    const size_t batch = 256;
+    float_net grad, m, v; // Градиенты пачки и моменты Adam
+    int t = 0;
+    const auto start = chrono::steady_clock::now();
+    for (int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        shuffle(samples.begin(), samples.end(), rng);
+        const float lr = 1e-3f * (epoch > epochs * 2 / 3 ? 0.1f : 1.f);
+        for (size_t first = 0; first < samples.size(); first += batch)
+        {
+            grad = float_net();
+            const size_t last = min(samples.size(), first + batch);
+            for (size_t k = first; k < last; ++k)
+            {
+                const train_sample& s = samples[k];
+                const float d = 2 * (net.forward(s, a1, h1, a2, h2) - s.target) / float(last - first);
+                float d1[NNUE_L1] = {};
+                grad.b3[0] += d;
+                for (int j = 0; j < NNUE_L2; ++j)
+                {
+                    grad.w3[j] += d * h2[j];
+                    if (a2[j] <= 0 || a2[j] >= 1)
+                        continue;
+                    const float d2 = d * net.w3[j];
+                    grad.b2[j] += d2;
+                    for (int i = 0; i < NNUE_L1; ++i)
+                    {
+                        grad.w2[j * NNUE_L1 + i] += d2 * h1[i];
+                        d1[i] += d2 * net.w2[j * NNUE_L1 + i];
+                    }
+                }
+                for (int i = 0; i < NNUE_L1; ++i)
+                {
+                    if (a1[i] <= 0 || a1[i] >= 1)
+                        continue;
+                    grad.b1[i] += d1[i];
+                    for (int f : s.features)
+                        grad.w1[f * NNUE_L1 + i] += d1[i];
+                }
+            }
+            ++t;
+            adam_step(net.w1, grad.w1, m.w1, v.w1, lr, t, float_net::W1_MAX);
+            adam_step(net.b1, grad.b1, m.b1, v.b1, lr, t, float_net::W1_MAX);
+            adam_step(net.w2, grad.w2, m.w2, v.w2, lr, t, float_net::W_MAX);
+            adam_step(net.b2, grad.b2, m.b2, v.b2, lr, t, 100.f);
+            adam_step(net.w3, grad.w3, m.w3, v.w3, lr, t, float_net::W_MAX);
+            adam_step(net.b3, grad.b3, m.b3, v.b3, lr, t, 100.f);
+        }
+        cout << "epoch " << epoch << ": train loss " << loss_on(samples) << ", validation loss " << loss_on(valid) << ", "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+    }
+
+    // Квантование: активации первых слоев в единицах NNUE_QA, веса int8 в единицах NNUE_QB
+    Nnue nnue;
+    for (int i = 0; i < NNUE_L1; ++i)
+    {
+        nnue.w.l1_bias[i] = int16_t(lround(net.b1[i] * NNUE_QA));
+        for (int f = 0; f < NNUE_INPUTS; ++f)
+            nnue.w.l1_weights[f][i] = int16_t(lround(net.w1[f * NNUE_L1 + i] * NNUE_QA));
+    }
+    for (int j = 0; j < NNUE_L2; ++j)
+    {
+        nnue.w.l2_bias[j] = int32_t(lround(net.b2[j] * NNUE_QA * NNUE_QB));
+        for (int i = 0; i < NNUE_L1; ++i)
+            nnue.w.l2_weights[j][i] = int8_t(lround(net.w2[j * NNUE_L1 + i] * NNUE_QB));
+        nnue.w.l3_weights[j] = int8_t(lround(net.w3[j] * NNUE_QB));
+    }
+    nnue.w.l3_bias = int32_t(lround(net.b3[0] * NNUE_QA * NNUE_QB));
+
+    // Ошибка квантованной сети на проверочных позициях и ее отличие от сети во float;
+    // аккумулятор считается в int32, чтобы заметить выход суммы за int16
+    double quant_loss = 0, max_diff = 0;
+    size_t overflows = 0;
+    for (const auto& s : valid)
+    {
+        int32_t sum[NNUE_L1];
+        copy(begin(nnue.w.l1_bias), end(nnue.w.l1_bias), sum);
+        for (int f : s.features)
+            for (int i = 0; i < NNUE_L1; ++i)
+                sum[i] += nnue.w.l1_weights[f][i];
+        nnue_accumulator acc;
+        bool overflow = false;
+        for (int i = 0; i < NNUE_L1; ++i)
+        {
+            overflow |= sum[i] < INT16_MIN || sum[i] > INT16_MAX;
+            acc.v[i] = int16_t(sum[i]);
+        }
+        overflows += overflow;
+        const double quantized = nnue.forward(acc) / double(NNUE_QA * NNUE_QB);
+        quant_loss += (quantized - s.target) * (quantized - s.target);
+        max_diff = max(max_diff, abs(quantized - net.forward(s, a1, h1, a2, h2)));
+    }
+    cout << "Quantized validation loss " << quant_loss / valid.size() << ", largest difference from the float net "
+         << max_diff << endl;
+    if (overflows)
+    {
+        cerr << "Accumulator overflows int16 in " << overflows << " positions" << endl;
+        return 1;
+    }
+
+    if (!nnue.save(out))
+    {
+        cerr << "Cannot write " << out << endl;
+        return 1;
+    }
+    cout << "Written " << out << endl;
+    return 0;
+}
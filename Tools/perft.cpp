@@ -0,0 +1,120 @@
+// Perft: число позиций на глубине N от заданной позиции для проверки и замера генератора ходов.
+// Серия взятий считается одним ходом, как в Logic::find_first_best_turn.
+//
+// Сборка: g++ -std=c++17 -O2 Tools/perft.cpp -o perft
+// Запуск: ./perft [--depth N] [--position STR] [--color 0|1] [--divide]
+//   --depth    - наибольшая глубина (по умолчанию 10), печатаются результаты для глубин 1..N
+//   --position - позиция строкой из 32 символов в формате Position::from_string (по умолчанию начальная)
+//   --color    - цвет, который ходит: 0 - белые, 1 - черные (по умолчанию 0)
+//   --divide   - число позиций на наибольшей глубине отдельно для каждого хода из корня
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "../Game/Bitboard.h"
+
+size_t perft(Position& pos, const bool color, const int depth);
+
+// Число позиций после шага turn; если фигура может бить дальше, перебираются продолжения серии
+size_t perft_turn(Position& pos, const bool color, const int depth, const bit_move turn)
+{
+    const undo_info undo = make_turn(pos, turn);
+    size_t nodes = 0;
+    MoveList turns;
+    if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+    {
+        for (const auto& next : turns)
+            nodes += perft_turn(pos, color, depth, next);
+    }
+    else
+        nodes = perft(pos, !color, depth - 1);
+    unmake_turn(pos, turn, undo);
+    return nodes;
+}
+
+// Число позиций на глубине depth
+size_t perft(Position& pos, const bool color, const int depth)
+{
+    if (depth == 0)
+        return 1;
+    MoveList turns;
+    const bool have_beats = gen_turns(pos, color, turns);
+    if (depth == 1 && !have_beats) // Тихие ходы на последнем уровне только считаем
+        return turns.size();
+    size_t nodes = 0;
+    for (const auto& turn : turns)
+        nodes += perft_turn(pos, color, depth, turn);
+    return nodes;
+}
+
+// Перебор ходов из корня с печатью числа позиций для каждой серии целиком
+size_t divide(Position& pos, const bool color, const int depth, const bit_move turn, const string& name)
+{
+    const string cur = name + (turn.cap != -1 ? ":" : "-") + square_name(turn.to);
+    const undo_info undo = make_turn(pos, turn);
+    size_t nodes = 0;
+    MoveList turns;
+    if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+    {
+        for (const auto& next : turns)
+            nodes += divide(pos, color, depth, next, cur);
+    }
+    else
+    {
+        nodes = perft(pos, !color, depth - 1);
+        cout << cur << ": " << nodes << endl;
+    }
+    unmake_turn(pos, turn, undo);
+    return nodes;
+}
+
+int main(int argc, char* argv[])
+{
+    int depth = 10;
+    bool color = 0;
+    bool is_divide = false;
+    Position pos = Position::start();
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--divide")
+            is_divide = true;
+        else if (arg == "--depth" && i + 1 < argc)
+            depth = stoi(argv[++i]);
+        else if (arg == "--color" && i + 1 < argc)
+            color = stoi(argv[++i]) != 0;
+        else if (arg == "--position" && i + 1 < argc)
+        {
+            if (!Position::from_string(argv[++i], pos))
+            {
+                cerr << "Bad position " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    for (int d = 1; d <= depth; ++d)
+    {
+        const auto start = chrono::steady_clock::now();
+        size_t nodes = 0;
+        if (is_divide && d == depth)
+        {
+            MoveList turns;
+            gen_turns(pos, color, turns);
+            for (const auto& turn : turns)
+                nodes += divide(pos, color, d, turn, square_name(turn.from));
+        }
+        else
+            nodes = perft(pos, color, d);
+        const double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("perft %2d: %14zu nodes, %10.1f ms, %12.0f nodes/sec\n", d, nodes, time * 1e3,
+               time > 0 ? nodes / time : 0.0);
+    }
+    return 0;
+}
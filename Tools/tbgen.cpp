@@ -0,0 +1,323 @@
+// Построение эндшпильных таблиц для всех позиций с числом фигур не больше N.
+// Таблицы строятся по полуходам, начиная с концов партии: на шаге ply позиция становится выигранной,
+// если есть ход в позицию, проигранную за ply - 1 полуходов, и проигранной, если все ходы ведут
+// в позиции, выигранные соперником не позднее ply - 1. Серия взятий считается одним ходом.
+// Взятия и превращения ведут в таблицы с меньшим числом фигур или простых, поэтому материалы
+// обрабатываются группами по числу фигур и простых, а группа - когда все нужные ей таблицы готовы.
+// Позиции каждого шага делятся между потоками.
+//
+// Сборка: g++ -std=c++17 -O2 -pthread Tools/tbgen.cpp -o tbgen
+// Запуск: ./tbgen [--pieces N] [--threads N] [--out FILE]
+//   --pieces  - наибольшее число фигур, от 2 до 6 (по умолчанию 4)
+//   --threads - число потоков (по умолчанию все ядра)
+//   --out     - файл таблиц (по умолчанию tablebase.bin, его читает бот по настройке "Tablebase")
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../Game/Tablebase.h"
+
+// Таблица одного материала в процессе построения
+struct tb_table
+{
+    tb_material m;
+    pair<int, int> group; // Число фигур и простых
+    vector<uint8_t> data; // Значения в формате файла
+};
+
+// Позиция в таблицах: номер таблицы и номер позиции в ней
+typedef pair<uint32_t, uint32_t> tb_ref;
+
+vector<tb_table> tables; // Все таблицы
+map<array<int, 4>, uint32_t> table_by_material; // Номер таблицы по материалу
+
+// Позиция с ходом белых в таблицах (позиция с ходом черных предварительно переворачивается)
+tb_ref find_ref(const Position& pos)
+{
+    const tb_material m = tb_material::of(pos);
+    const auto it = table_by_material.find({ m.wm, m.wk, m.bm, m.bk });
+    if (it == table_by_material.end())
+    {
+        cerr << "No table for material " << m.wm << "+" << m.wk << " v " << m.bm << "+" << m.bk << " (position "
+             << pos.to_string() << ")" << endl;
+        exit(1);
+    }
+    return { it->second, uint32_t(tb_index(pos)) };
+}
+
+// Перебор позиций после всех ходов белых целиком (с сериями взятий)
+template <class F> void for_each_turn(Position& pos, const bit_move turn, F& visit)
+{
+    const undo_info undo = make_turn(pos, turn);
+    MoveList turns;
+    if (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+    {
+        for (const auto& next : turns)
+            for_each_turn(pos, next, visit);
+    }
+    else
+        visit(pos);
+    unmake_turn(pos, turn, undo);
+}
+
+// Перебор позиций после всех ходов белых: visit(значение для черных, позиция в таблицах или -1, если
+// у черных не осталось фигур)
+template <class F> void for_each_child(Position pos, F&& visit)
+{
+    MoveList turns;
+    gen_turns(pos, 0, turns);
+    auto visit_pos = [&visit](const Position& next) {
+        const Position cur = tb_flip(next);
+        if (!cur.white) // Черных фигур не осталось - проигрыш черных
+        {
+            visit(uint8_t(1), tb_ref(UINT32_MAX, 0));
+            return;
+        }
+        const tb_ref ref = find_ref(cur);
+        visit(tables[ref.first].data[ref.second], ref);
+    };
+    for (const auto& turn : turns)
+        for_each_turn(pos, turn, visit_pos);
+}
+
+// Значение позиции на шаге ply (0, если еще не известно); значения соперника с расстоянием ply
+// и больше не учитываются, чтобы расстояние до конца партии было наименьшим
+uint8_t evaluate(const Position& pos, const int ply)
+{
+    int min_loss = 255; // Наименьшее расстояние до проигрыша соперника
+    int max_win = -1; // Наибольшее расстояние до выигрыша соперника
+    bool all_win = true; // Все ходы ведут к выигрышу соперника
+    for_each_child(pos, [&](const uint8_t value, tb_ref) {
+        const int dist = value - 1;
+        if (!value || dist >= ply)
+            all_win = false;
+        else if (dist % 2)
+            max_win = max(max_win, dist);
+        else
+            min_loss = min(min_loss, dist);
+    });
+    if (min_loss < 255)
+        return uint8_t(min_loss + 2);
+    if (all_win) // В том числе, если ходов нет
+        return uint8_t(max_win + 2);
+    return 0;
+}
+
+// Позиции с ходом белых, из которых тихим ходом (без взятия и превращения) получается позиция pos
+// с ходом белых после переворота; это позиции той же группы материала
+void add_parents(const Position& pos, vector<tb_ref>& parents)
+{
+    // В pos только что ходили черные: возвращаем черную фигуру назад
+    const BB empty = pos.empty();
+    for (BB b = pos.black; b; b &= b - 1)
+    {
+        const int sq = lsb(b);
+        const bool is_king = (pos.kings >> sq) & 1;
+        for (int dir = 0; dir < (is_king ? 4 : 2); ++dir) // Простые черные ходят вниз, назад - вверх
+        {
+            for (int s = NEIGHBOR[sq][dir]; s != -1 && ((empty >> s) & 1); s = NEIGHBOR[s][dir])
+            {
+                Position prev = pos;
+                prev.black ^= (BB(1) << sq) | (BB(1) << s);
+                if (is_king)
+                    prev.kings ^= (BB(1) << sq) | (BB(1) << s);
+                prev.refresh();
+                MoveList turns;
+                if (!gen_turns(prev, 1, turns)) // При возможности взятия тихий ход был невозможен
+                    parents.push_back(find_ref(tb_flip(prev)));
+                if (!is_king)
+                    break;
+            }
+        }
+    }
+}
+
+// Запуск f(t) в threads потоках
+template <class F> void parallel(const int threads, F&& f)
+{
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(f, t);
+    for (auto& th : pool)
+        th.join();
+}
+
+// Построение группы материалов с одинаковым числом фигур и простых.
+// На шаге ply пересчитываются только позиции, у которых на прошлом шаге появился результат хода:
+// родители позиций, решенных на шаге ply - 1, и позиции со взятием или превращением в уже готовую
+// таблицу с расстоянием ply - 1.
+void solve_group(const vector<uint32_t>& group, const int threads)
+{
+    const pair<int, int> key = tables[group[0]].group;
+    vector<vector<tb_ref>> planned(256); // Позиции для пересчета по шагам
+    vector<vector<vector<tb_ref>>> found(threads, vector<vector<tb_ref>>(256));
+    for (uint32_t id : group)
+    {
+        parallel(threads, [&, id](const int t) {
+            const tb_table& table = tables[id];
+            for (uint64_t idx = t; idx < table.data.size(); idx += threads)
+            {
+                Position pos;
+                if (!tb_position(table.m, idx, pos))
+                    continue;
+                bool has_turns = false;
+                for_each_child(pos, [&](const uint8_t value, const tb_ref ref) {
+                    has_turns = true;
+                    if (value && (ref.first == UINT32_MAX || tables[ref.first].group != key))
+                        found[t][value].emplace_back(id, uint32_t(idx));
+                });
+                if (!has_turns)
+                    found[t][0].emplace_back(id, uint32_t(idx));
+            }
+        });
+    }
+    for (auto& part : found)
+        for (int ply = 0; ply < 256; ++ply)
+            planned[ply].insert(planned[ply].end(), part[ply].begin(), part[ply].end());
+
+    vector<tb_ref> cur;
+    for (int ply = 0; ply < 256; ++ply)
+    {
+        cur.insert(cur.end(), planned[ply].begin(), planned[ply].end());
+        planned[ply] = {};
+        sort(cur.begin(), cur.end());
+        cur.erase(unique(cur.begin(), cur.end()), cur.end());
+        if (cur.empty())
+            continue;
+        if (ply > 254)
+        {
+            cerr << "Distance to the end of the game does not fit into a byte" << endl;
+            exit(1);
+        }
+
+        // Потоки только читают таблицы; новые значения записываются после шага
+        vector<vector<pair<tb_ref, uint8_t>>> solved(threads);
+        parallel(threads, [&](const int t) {
+            for (size_t i = t; i < cur.size(); i += threads)
+            {
+                const tb_table& table = tables[cur[i].first];
+                if (table.data[cur[i].second])
+                    continue;
+                Position pos;
+                tb_position(table.m, cur[i].second, pos);
+                const uint8_t value = evaluate(pos, ply);
+                if (value)
+                    solved[t].emplace_back(cur[i], value);
+            }
+        });
+        for (const auto& part : solved)
+            for (const auto& [ref, value] : part)
+                tables[ref.first].data[ref.second] = value;
+
+        // Родители решенных позиций пересчитываются на следующем шаге
+        vector<vector<tb_ref>> parents(threads);
+        parallel(threads, [&](const int t) {
+            for (const auto& [ref, value] : solved[t])
+            {
+                Position pos;
+                tb_position(tables[ref.first].m, ref.second, pos);
+                add_parents(pos, parents[t]);
+            }
+        });
+        cur.clear();
+        for (const auto& part : parents)
+            cur.insert(cur.end(), part.begin(), part.end());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int pieces = 4;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    string out = "tablebase.bin";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--pieces")
+            pieces = stoi(argv[i + 1]);
+        else if (arg == "--threads")
+            threads = max(1, stoi(argv[i + 1]));
+        else if (arg == "--out")
+            out = argv[i + 1];
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    if (pieces < 2 || pieces > TB_MAX_PIECES)
+    {
+        cerr << "Number of pieces must be from 2 to " << TB_MAX_PIECES << endl;
+        return 1;
+    }
+
+    // Все материалы, где у каждой стороны есть фигуры, сгруппированные по числу фигур и простых.
+    // Взятия и превращения ведут в материалы с тем же или меньшим числом фигур, поэтому пропускать
+    // таблицы нельзя: на каждую из них могут ссылаться другие
+    map<pair<int, int>, vector<uint32_t>> groups;
+    for (int wm = 0; wm <= pieces; ++wm)
+        for (int wk = 0; wm + wk <= pieces; ++wk)
+            for (int bm = 0; wm + wk + bm <= pieces; ++bm)
+                for (int bk = 0; wm + wk + bm + bk <= pieces; ++bk)
+                {
+                    const tb_material m{ wm, wk, bm, bk };
+                    if (!(wm + wk) || !(bm + bk))
+                        continue;
+                    if (tb_size(m) > UINT32_MAX)
+                    {
+                        cerr << "Table " << wm << "+" << wk << " v " << bm << "+" << bk << " is too large" << endl;
+                        return 1;
+                    }
+                    table_by_material[{ wm, wk, bm, bk }] = uint32_t(tables.size());
+                    groups[{ m.total(), wm + bm }].push_back(uint32_t(tables.size()));
+                    tables.push_back({ m, { m.total(), wm + bm }, vector<uint8_t>(tb_size(m)) });
+                }
+
+    int max_dist = 0;
+    for (const auto& [key, group] : groups)
+    {
+        const auto start = chrono::steady_clock::now();
+        solve_group(group, threads);
+        size_t wins = 0, losses = 0, positions = 0;
+        for (uint32_t id : group)
+        {
+            positions += tables[id].data.size();
+            for (uint8_t value : tables[id].data)
+            {
+                wins += value && (value - 1) % 2;
+                losses += value && !((value - 1) % 2);
+                max_dist = max(max_dist, value - 1);
+            }
+        }
+        cout << key.first << " pieces, " << key.second << " men: " << group.size() << " tables, " << positions
+             << " indices, " << wins << " wins, " << losses << " losses, longest " << max_dist << " plies, "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+    }
+
+    // Запись файла: заголовок, каталог, данные таблиц
+    ofstream fout(out, ios::binary);
+    tb_header header{ { 'C', 'K', 'T', 'B' }, TB_VERSION, uint32_t(pieces), uint32_t(tables.size()) };
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t offset = sizeof(header) + tables.size() * sizeof(tb_table_info);
+    for (const auto& table : tables)
+    {
+        const tb_table_info info{ uint8_t(table.m.wm), uint8_t(table.m.wk), uint8_t(table.m.bm), uint8_t(table.m.bk), 0,
+                                  offset, table.data.size() };
+        fout.write(reinterpret_cast<const char*>(&info), sizeof(info));
+        offset += table.data.size();
+    }
+    for (const auto& table : tables)
+        fout.write(reinterpret_cast<const char*>(table.data.data()), streamsize(table.data.size()));
+    if (!fout)
+    {
+        cerr << "Cannot write " << out << endl;
+        return 1;
+    }
+    cout << "Written " << out << ", " << offset << " bytes" << endl;
+    return 0;
+}
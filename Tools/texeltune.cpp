@@ -0,0 +1,329 @@
+// Подбор весов оценок по результатам партий (метод Texel). Бот играет сам с собой из случайных начал,
+// каждая спокойная позиция (у ходящего нет взятий) помечается результатом партии. Затем оценка переводится
+// в вероятность выигрыша черных p = r^K / (1 + r^K), где r - отношение материала черных к материалу белых,
+// и веса подбираются покоординатным спуском по среднеквадратичной ошибке p против результата:
+// сначала масштаб K при текущих весах, затем веса вместе с K в допустимых диапазонах (вес ряда потенциала
+// до 0.5, дамка от 1 до 10 простых). Ошибка считается всеми потоками.
+// Оценка зависит только от числа фигур и потенциала, поэтому одинаковые позиции по этим слагаемым
+// сворачиваются в одну запись с числом позиций и суммой результатов - миллионы позиций считаются быстро.
+//
+// Сборка: g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/texeltune.cpp -o texeltune
+// Запуск: ./texeltune [--games N] [--level N] [--plies N] [--max-turns N] [--threads N] [--seed N]
+//                     [--data FILE] [--save FILE] [--out FILE]
+//   --games     - число партий для набора позиций (по умолчанию 20000)
+//   --level     - уровень бота в партиях (по умолчанию 2)
+//   --plies     - число случайных полуходов в начале партии (по умолчанию 6)
+//   --max-turns - число ходов, после которого партия - ничья (по умолчанию 120)
+//   --threads   - число потоков (по умолчанию все ядра)
+//   --seed      - начальное значение генератора начал партий (по умолчанию 1)
+//   --data      - позиции из файла (записанного --save) вместо партий
+//   --save      - записать набранные позиции в файл
+//   --out       - файл весов (по умолчанию weights.json, его читает бот по настройке "Weights")
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Game/Logic.h"
+
+// Позиция, помеченная результатом партии (запись файла --data / --save)
+struct texel_record
+{
+    int8_t men_count[2], kings_count[2], potential[2];
+    uint8_t result; // 0 - выигрыш белых, 1 - ничья, 2 - выигрыш черных
+};
+
+// Позиции с одинаковыми слагаемыми оценки
+struct texel_group
+{
+    eval_terms terms;
+    double count = 0, sum = 0, sum_sq = 0; // Число позиций, сумма и сумма квадратов результатов (1 - черные)
+};
+
+// Начало партии: случайные ходы из начальной позиции (серия взятий - один ход)
+pair<Position, bool> make_opening(mt19937& rng, const int plies)
+{
+    while (true)
+    {
+        Position pos = Position::start();
+        bool color = 0;
+        int ply = 0;
+        for (; ply < plies; ++ply)
+        {
+            MoveList turns;
+            gen_turns(pos, color, turns);
+            if (turns.empty())
+                break;
+            bit_move turn = turns[int(rng() % turns.size())];
+            make_turn(pos, turn);
+            while (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+            {
+                turn = turns[int(rng() % turns.size())];
+                make_turn(pos, turn);
+            }
+            color = !color;
+        }
+        if (ply == plies)
+            return { pos, color };
+    }
+}
+
+// Партия бота с самим собой; спокойные позиции с обеими сторонами на доске добавляются в records
+void play_game(Logic& logic, const pair<Position, bool>& opening, const int max_turns, vector<texel_record>& records)
+{
+    Position pos = opening.first;
+    bool color = opening.second;
+    const size_t first = records.size();
+    uint8_t result = 1;
+    for (int turn_num = 0; turn_num < max_turns; ++turn_num, color = !color)
+    {
+        MoveList turns;
+        const bool captures = gen_turns(pos, color, turns);
+        if (turns.empty()) // Ходов нет - поражение того, кто ходит
+        {
+            result = color ? 0 : 2;
+            break;
+        }
+        if (!captures)
+            records.push_back({ { pos.men_count[0], pos.men_count[1] },
+                                { pos.kings_count[0], pos.kings_count[1] },
+                                { pos.potential[0], pos.potential[1] },
+                                0 });
+        for (const auto& turn : logic.find_best_turns(color, pos))
+            make_turn(pos, bit_move(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2),
+                                    turn.xb == -1 ? -1 : sq_index(turn.xb, turn.yb)));
+    }
+    for (size_t i = first; i < records.size(); ++i)
+        records[i].result = result;
+}
+
+// Свертка позиций по слагаемым оценки
+vector<texel_group> group_records(const vector<texel_record>& records)
+{
+    map<array<int, 6>, texel_group> groups;
+    for (const auto& r : records)
+    {
+        if (r.men_count[0] + r.kings_count[0] == 0 || r.men_count[1] + r.kings_count[1] == 0)
+            continue; // Оценка без фигур одной из сторон - выигрыш, такие позиции не помогают подбору
+        auto& g = groups[{ r.men_count[0], r.men_count[1], r.kings_count[0], r.kings_count[1], r.potential[0],
+                           r.potential[1] }];
+        g.terms = { { r.men_count[0], r.men_count[1] },
+                    { r.kings_count[0], r.kings_count[1] },
+                    { r.potential[0], r.potential[1] } };
+        const double res = r.result * 0.5;
+        g.count += 1;
+        g.sum += res;
+        g.sum_sq += res * res;
+    }
+    vector<texel_group> res;
+    for (const auto& item : groups)
+        res.push_back(item.second);
+    return res;
+}
+
+// Среднеквадратичная ошибка вероятности выигрыша черных по оценке Eval с весами w и масштабом k
+template <class Eval>
+double texel_error(const vector<texel_group>& groups, const eval_weights& w, const double k, const int threads)
+{
+    vector<double> partial(threads);
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            double err = 0;
+            for (size_t i = t; i < groups.size(); i += threads)
+            {
+                const auto& g = groups[i];
+                const double p = 1 / (1 + exp(-k * Eval::score(g.terms, 1, w) / SCORE_SCALE));
+                err += g.count * p * p - 2 * p * g.sum + g.sum_sq;
+            }
+            partial[t] = err;
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+    double err = 0, count = 0;
+    for (double e : partial)
+        err += e;
+    for (const auto& g : groups)
+        count += g.count;
+    return err / count;
+}
+
+// Подбираемый параметр: значение, начальный шаг и допустимый диапазон
+struct tuned_param
+{
+    double* value;
+    double step, min, max;
+};
+
+// Покоординатный спуск: шаг по каждому параметру в обе стороны, пока ошибка уменьшается,
+// затем шаги уменьшаются вдвое. Диапазоны нужны, потому что отношение материала не меняется
+// при умножении всех весов на одно число: без них веса потенциала и дамки растут вместе без предела,
+// а вес простой (1) перестает что-либо значить.
+void coordinate_descent(vector<tuned_param> params, const function<double()>& error, const string& name)
+{
+    double best = error();
+    for (int round = 0; round < 12; ++round)
+    {
+        bool improved = true;
+        while (improved)
+        {
+            improved = false;
+            for (auto& param : params)
+            {
+                for (const double dir : { 1.0, -1.0 })
+                {
+                    const double old = *param.value;
+                    *param.value = clamp(old + dir * param.step, param.min, param.max);
+                    const double err = *param.value != old ? error() : best;
+                    if (err < best)
+                    {
+                        best = err;
+                        improved = true;
+                        break;
+                    }
+                    *param.value = old;
+                }
+            }
+        }
+        for (auto& param : params)
+            param.step /= 2;
+    }
+    cout << name << ": error " << best << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int games = 20000;
+    int level = 2;
+    int plies = 6;
+    int max_turns = 120;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    unsigned seed = 1;
+    string data_file, save_file, out_file = "weights.json";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--games")
+            games = stoi(argv[i + 1]);
+        else if (arg == "--level")
+            level = stoi(argv[i + 1]);
+        else if (arg == "--plies")
+            plies = stoi(argv[i + 1]);
+        else if (arg == "--max-turns")
+            max_turns = stoi(argv[i + 1]);
+        else if (arg == "--threads")
+            threads = max(1, stoi(argv[i + 1]));
+        else if (arg == "--seed")
+            seed = unsigned(stoul(argv[i + 1]));
+        else if (arg == "--data")
+            data_file = argv[i + 1];
+        else if (arg == "--save")
+            save_file = argv[i + 1];
+        else if (arg == "--out")
+            out_file = argv[i + 1];
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    const auto start = chrono::steady_clock::now();
+    auto elapsed = [&start] { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+    vector<texel_record> records;
+    if (!data_file.empty())
+    {
+        ifstream fin(data_file, ios::binary);
+        texel_record r;
+        while (fin.read(reinterpret_cast<char*>(&r), sizeof(r)))
+            records.push_back(r);
+        if (records.empty())
+        {
+            cerr << "No positions in " << data_file << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        // Партии ботом с весами по умолчанию, без книги и таблиц: позиции и результаты - только от поиска
+        const json config = { { "Bot",
+                                { { "BotScoringType", "NumberAndPotential" },
+                                  { "NoRandom", false },
+                                  { "Optimization", "O1" },
+                                  { "Threads", 1 },
+                                  { "Tablebase", "" },
+                                  { "Book", "" },
+                                  { "Nnue", "" },
+                                  { "Weights", "" },
+                                  { "Ponder", false } } } };
+        mt19937 rng(seed);
+        vector<pair<Position, bool>> openings;
+        for (int i = 0; i < games; ++i)
+            openings.push_back(make_opening(rng, plies));
+        atomic<int> next_game{ 0 };
+        mutex records_mutex;
+        vector<thread> pool;
+        for (int t = 0; t < threads; ++t)
+        {
+            pool.emplace_back([&] {
+                Config cfg(config);
+                vector<texel_record> local;
+                for (int g; (g = next_game++) < games;)
+                {
+                    Logic logic(&cfg);
+                    logic.Max_depth = level;
+                    play_game(logic, openings[g], max_turns, local);
+                }
+                lock_guard<mutex> lock(records_mutex);
+                records.insert(records.end(), local.begin(), local.end());
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+        cout << "Games: " << games << ", positions: " << records.size() << ", " << elapsed() << " s" << endl;
+        if (!save_file.empty())
+        {
+            ofstream fout(save_file, ios::binary);
+            fout.write(reinterpret_cast<const char*>(records.data()), streamsize(records.size() * sizeof(texel_record)));
+        }
+    }
+
+    const vector<texel_group> groups = group_records(records);
+    cout << "Distinct positions by evaluation terms: " << groups.size() << endl;
+
+    eval_weights w;
+    const eval_weights initial = w;
+    double k_number = 1, k_potential = 1;
+    auto number_error = [&] { return texel_error<NumberOnlyEval>(groups, w, k_number, threads); };
+    auto potential_error = [&] { return texel_error<NumberAndPotentialEval>(groups, w, k_potential, threads); };
+
+    // Масштаб при весах по умолчанию, затем веса вместе с масштабом
+    coordinate_descent({ { &k_number, 0.5, 0.01, 100 } }, number_error, "NumberOnly, scale");
+    coordinate_descent({ { &w.king_number_only, 0.5, 1, 10 }, { &k_number, 0.5, 0.01, 100 } }, number_error,
+                       "NumberOnly, tuned");
+    coordinate_descent({ { &k_potential, 0.5, 0.01, 100 } }, potential_error, "NumberAndPotential, scale");
+    coordinate_descent({ { &w.potential, 0.02, 0, 0.5 }, { &w.king, 0.5, 1, 10 }, { &k_potential, 0.5, 0.01, 100 } },
+                       potential_error, "NumberAndPotential, tuned");
+
+    cout << "KingNumberOnly: " << initial.king_number_only << " -> " << w.king_number_only << endl;
+    cout << "Potential: " << initial.potential << " -> " << w.potential << endl;
+    cout << "King: " << initial.king << " -> " << w.king << endl;
+    if (!save_eval_weights(out_file, w))
+    {
+        cerr << "Cannot write " << out_file << endl;
+        return 1;
+    }
+    cout << "Saved " << out_file << ", " << elapsed() << " s" << endl;
+    return 0;
+}
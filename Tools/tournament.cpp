@@ -0,0 +1,284 @@
+// Турнир двух настроек бота без окна SDL: партии играются параллельно (по партии на поток),
+// каждое начало партии играется дважды со сменой цветов. Печатаются выигрыши, ничьи и поражения
+// первой настройки, оценка разницы Elo с 95% интервалом и решение SPRT: турнир останавливается,
+// как только логарифм отношения правдоподобия выходит за границы.
+//
+// Настройка бота - JSON в формате settings.json (используется раздел "Bot", отсутствующие настройки
+// берутся по умолчанию), файлом или строкой, например '{"Bot": {"BotScoringType": "NumberOnly"}}'.
+//
+// Сборка: g++ -std=c++17 -O2 -pthread -I<путь к nlohmann/json> Tools/tournament.cpp -o tournament
+// Запуск: ./tournament --a A --b B [--level-a N] [--level-b N] [--games N] [--threads N] [--plies N]
+//                      [--max-turns N] [--seed N] [--sprt ELO0,ELO1] [--stats FILE]
+//   --a, --b       - настройки двух ботов (файл или строка JSON; по умолчанию настройки по умолчанию)
+//   --level-a, -b  - уровни ботов (по умолчанию 4)
+//   --games        - наибольшее число партий (по умолчанию 1000)
+//   --threads      - число потоков (по умолчанию все ядра)
+//   --plies        - число случайных полуходов в начале партии (по умолчанию 4)
+//   --max-turns    - число ходов, после которого партия - ничья (по умолчанию 120, как MaxNumTurns)
+//   --seed         - начальное значение генератора начал партий (по умолчанию 1)
+//   --sprt         - гипотезы SPRT: разница Elo H0 и H1 (по умолчанию 0,10; ошибки первого и второго рода 5%)
+//   --stats        - файл статистики поиска: строка JSON на каждый ход бота (Logic::search_report)
+//                    с номером партии и ботом ("A" или "B")
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Game/Logic.h"
+
+// Итог партии для первого бота
+enum class GameResult
+{
+    WIN,
+    DRAW,
+    LOSS
+};
+
+// Настройки бота из файла или строки JSON
+json read_engine(const string& arg)
+{
+    json res = json::object();
+    if (!arg.empty() && arg[0] == '{')
+        res = json::parse(arg);
+    else if (!arg.empty())
+    {
+        ifstream fin(arg);
+        if (!fin)
+            throw runtime_error("cannot open " + arg);
+        fin >> res;
+    }
+    res["Bot"]["Ponder"] = false; // В турнире соперник не думает на своем времени
+    res["Bot"]["Book"] = ""; // Дебюты партий задаются турниром, а не книгой
+    return res;
+}
+
+// Начало партии: случайные ходы из начальной позиции (серия взятий - один ход)
+pair<Position, bool> make_opening(mt19937& rng, const int plies)
+{
+    while (true)
+    {
+        Position pos = Position::start();
+        bool color = 0;
+        int ply = 0;
+        for (; ply < plies; ++ply)
+        {
+            MoveList turns;
+            gen_turns(pos, color, turns);
+            if (turns.empty())
+                break;
+            bit_move turn = turns[int(rng() % turns.size())];
+            make_turn(pos, turn);
+            while (turn.cap != -1 && gen_piece_turns(pos, turn.to, turns))
+            {
+                turn = turns[int(rng() % turns.size())];
+                make_turn(pos, turn);
+            }
+            color = !color;
+        }
+        if (ply == plies)
+            return { pos, color };
+    }
+}
+
+// Партия двух ботов из начала opening; первый бот (bots[0]) играет белыми, если a_is_white.
+// Боты создаются один раз на поток, перед партией у них сбрасывается только состояние прошлой партии.
+// Если reports не nullptr, в него добавляется статистика поиска каждого хода
+GameResult play_game(Logic* bots[2], const pair<Position, bool>& opening, const int max_turns, const bool a_is_white,
+                     vector<json>* reports)
+{
+    Logic& white = *bots[a_is_white ? 0 : 1];
+    Logic& black = *bots[a_is_white ? 1 : 0];
+    white.new_game();
+    black.new_game();
+    Position pos = opening.first;
+    bool color = opening.second;
+    for (int turn_num = 0; turn_num < max_turns; ++turn_num, color = !color)
+    {
+        MoveList turns;
+        gen_turns(pos, color, turns);
+        if (turns.empty()) // Ходов нет - поражение того, кто ходит
+            return (color == 0) == a_is_white ? GameResult::LOSS : GameResult::WIN;
+        Logic& logic = color ? black : white;
+        const auto best = logic.find_best_turns(color, pos);
+        if (reports)
+        {
+            reports->push_back(logic.search_report(color, pos, best));
+            reports->back()["engine"] = (color == 0) == a_is_white ? "A" : "B";
+        }
+        for (const auto& turn : best)
+            make_turn(pos, bit_move(sq_index(turn.x, turn.y), sq_index(turn.x2, turn.y2),
+                                    turn.xb == -1 ? -1 : sq_index(turn.xb, turn.yb)));
+    }
+    return GameResult::DRAW;
+}
+
+// Ожидаемая доля очков при разнице Elo
+double expected_score(const double elo)
+{
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+// Разница Elo по доле очков
+double elo_of(const double score)
+{
+    return -400 * log10(1 / score - 1);
+}
+
+int main(int argc, char* argv[])
+{
+    string engine_args[2];
+    int levels[2] = { 4, 4 };
+    int games = 1000;
+    int threads = max(1, int(thread::hardware_concurrency()));
+    int plies = 4;
+    int max_turns = 120;
+    unsigned seed = 1;
+    string stats_file;
+    double elo0 = 0, elo1 = 10;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const string arg = argv[i];
+        if (arg == "--a")
+            engine_args[0] = argv[i + 1];
+        else if (arg == "--b")
+            engine_args[1] = argv[i + 1];
+        else if (arg == "--level-a")
+            levels[0] = stoi(argv[i + 1]);
+        else if (arg == "--level-b")
+            levels[1] = stoi(argv[i + 1]);
+        else if (arg == "--games")
+            games = stoi(argv[i + 1]);
+        else if (arg == "--threads")
+            threads = max(1, stoi(argv[i + 1]));
+        else if (arg == "--plies")
+            plies = stoi(argv[i + 1]);
+        else if (arg == "--max-turns")
+            max_turns = stoi(argv[i + 1]);
+        else if (arg == "--seed")
+            seed = unsigned(stoul(argv[i + 1]));
+        else if (arg == "--stats")
+            stats_file = argv[i + 1];
+        else if (arg == "--sprt")
+        {
+            stringstream ss(argv[i + 1]);
+            char comma;
+            if (!(ss >> elo0 >> comma >> elo1) || comma != ',' || elo0 >= elo1)
+            {
+                cerr << "Bad --sprt " << argv[i + 1] << endl;
+                return 1;
+            }
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    json engines[2];
+    try
+    {
+        for (int e = 0; e < 2; ++e)
+        {
+            engines[e] = read_engine(engine_args[e]);
+            Config check(engines[e]); // Ошибки настроек - до начала турнира
+        }
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    // Начала партий заранее: каждое - на пару партий со сменой цветов
+    mt19937 rng(seed);
+    vector<pair<Position, bool>> openings;
+    for (int i = 0; i < (games + 1) / 2; ++i)
+        openings.push_back(make_opening(rng, plies));
+
+    const double lower = log(0.05 / (1 - 0.05)), upper = log((1 - 0.05) / 0.05); // Границы SPRT
+    int wins = 0, draws = 0, losses = 0;
+    string decision;
+    mutex results_mutex;
+    ofstream stats;
+    if (!stats_file.empty())
+        stats.open(stats_file);
+    atomic<int> next_game{ 0 };
+    atomic<bool> stop{ false };
+    const auto start = chrono::steady_clock::now();
+
+    // Статистика по сыгранным партиям: Elo с 95% интервалом и LLR для гипотез elo0 / elo1
+    auto report = [&](ostream& out) {
+        const int n = wins + draws + losses;
+        const double score = (wins + 0.5 * draws) / n;
+        const double variance = (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / n;
+        const double margin = 1.96 * sqrt(variance / n);
+        const double s0 = expected_score(elo0), s1 = expected_score(elo1);
+        const double llr = variance > 0 ? n * (pow(score - s0, 2) - pow(score - s1, 2)) / (2 * variance) : 0;
+        out << "Games " << n << ": +" << wins << " =" << draws << " -" << losses << ", Elo " << elo_of(score) << " ["
+            << elo_of(max(1e-6, score - margin)) << ", " << elo_of(min(1 - 1e-6, score + margin)) << "], LLR " << llr
+            << " [" << lower << ", " << upper << "], "
+            << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+        return llr;
+    };
+
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&] {
+            Config config_a(engines[0]), config_b(engines[1]);
+            Logic bot_a(&config_a), bot_b(&config_b); // Таблицы, книга, веса и сеть загружаются один раз
+            bot_a.Max_depth = levels[0];
+            bot_b.Max_depth = levels[1];
+            Logic* bots[2] = { &bot_a, &bot_b };
+            for (int g; !stop && (g = next_game++) < games;)
+            {
+                vector<json> reports;
+                const GameResult res = play_game(bots, openings[g / 2], max_turns, g % 2 == 0,
+                                                 stats.is_open() ? &reports : nullptr);
+                lock_guard<mutex> lock(results_mutex);
+                for (auto& report : reports)
+                {
+                    report["game"] = g;
+                    stats << report.dump() << "\n";
+                }
+                if (stop)
+                    break;
+                wins += res == GameResult::WIN;
+                draws += res == GameResult::DRAW;
+                losses += res == GameResult::LOSS;
+                const int n = wins + draws + losses;
+                ostringstream line;
+                const double llr = report(line);
+                if (n % 100 == 0)
+                    cout << line.str();
+                if (llr >= upper || llr <= lower)
+                {
+                    ostringstream text;
+                    if (llr >= upper)
+                        text << "H1 accepted: A is stronger by at least " << elo1 << " Elo";
+                    else
+                        text << "H0 accepted: A is not stronger by " << elo1 << " Elo";
+                    decision = text.str();
+                    stop = true;
+                }
+            }
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+
+    const int played = wins + draws + losses;
+    if (played == 0)
+        return 0;
+    if (played % 100 != 0) // Кратные 100 уже напечатаны
+        report(cout);
+    cout << (decision.empty() ? "SPRT: no decision" : "SPRT: " + decision) << endl;
+    return 0;
+}